@@ -0,0 +1,107 @@
+#include "automaton.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace
+{
+constexpr std::size_t ROWS_PER_TASK = 16;
+constexpr int MAX_NEIGHBOURS = 8;
+constexpr int WORD_BITS = 64;
+
+// a + b + c as a sum bit and a carry bit, for 64 cells at once
+void FullAdd(std::uint64_t a, std::uint64_t b, std::uint64_t c, std::uint64_t& sum, std::uint64_t& carry)
+{
+    const std::uint64_t half = a ^ b;
+    sum = half ^ c;
+    carry = (a & b) | (half & c);
+}
+
+// Four bit-slices of the number of set neighbours of every cell in a word, least significant first
+std::array<std::uint64_t, 4> CountNeighbours(const std::array<std::uint64_t, 8>& neighbours)
+{
+    std::uint64_t sumA, carryA, sumB, carryB;
+    FullAdd(neighbours[0], neighbours[1], neighbours[2], sumA, carryA);
+    FullAdd(neighbours[3], neighbours[4], neighbours[5], sumB, carryB);
+    const std::uint64_t sumC = neighbours[6] ^ neighbours[7];
+    const std::uint64_t carryC = neighbours[6] & neighbours[7];
+
+    std::uint64_t ones, carryOnes;
+    FullAdd(sumA, sumB, sumC, ones, carryOnes);
+    std::uint64_t twos, carryTwos;
+    FullAdd(carryA, carryB, carryC, twos, carryTwos);
+    const std::uint64_t carryFours = twos & carryOnes;
+    twos ^= carryOnes;
+    return {ones, twos, carryTwos ^ carryFours, carryTwos & carryFours};
+}
+
+// Cells whose count is in the set
+std::uint64_t Matching(const std::array<std::uint64_t, 4>& count, std::uint16_t set)
+{
+    std::uint64_t result = 0;
+    for (int n = 0; n <= MAX_NEIGHBOURS; ++n)
+    {
+        if (((set >> n) & 1U) == 0)
+        {
+            continue;
+        }
+        std::uint64_t match = ~std::uint64_t{0};
+        for (int bit = 0; bit < 4; ++bit)
+        {
+            match &= ((n >> bit) & 1) != 0 ? count[bit] : ~count[bit];
+        }
+        result |= match;
+    }
+    return result;
+}
+}    // namespace
+
+void Automaton::Run(Bitplane& plane, Rule rule, int steps, Vector2<int> rows, bool outside)
+{
+    const int top = std::max(rows.x, 0);
+    const int bottom = std::min(rows.y, plane.GetHeight());
+    if (top >= bottom)
+    {
+        return;
+    }
+
+    // Columns past the width stay clear
+    const int lastBits = plane.GetWidth() - (plane.GetWords() - 1) * WORD_BITS;
+    const std::uint64_t lastWord = lastBits >= WORD_BITS ? ~std::uint64_t{0} : (std::uint64_t{1} << lastBits) - 1;
+
+    Bitplane other = plane;
+    Bitplane* current = &plane;
+    Bitplane* next = &other;
+    for (int step = 0; step < steps; ++step)
+    {
+        Parallel::ForRange(bottom - top, ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+            for (int y = top + static_cast<int>(begin); y < top + static_cast<int>(end); ++y)
+            {
+                std::uint64_t* out = next->Row(y);
+                for (int word = 0; word < plane.GetWords(); ++word)
+                {
+                    const std::array<std::uint64_t, 8> neighbours{
+                        current->Shifted(word, y - 1, -1, outside),
+                        current->Shifted(word, y - 1, 0, outside),
+                        current->Shifted(word, y - 1, 1, outside),
+                        current->Shifted(word, y, -1, outside),
+                        current->Shifted(word, y, 1, outside),
+                        current->Shifted(word, y + 1, -1, outside),
+                        current->Shifted(word, y + 1, 0, outside),
+                        current->Shifted(word, y + 1, 1, outside),
+                    };
+                    const std::array<std::uint64_t, 4> count = CountNeighbours(neighbours);
+                    const std::uint64_t alive = current->Word(word, y, false);
+                    out[word] = (~alive & Matching(count, rule.birth)) | (alive & Matching(count, rule.survival));
+                }
+                out[plane.GetWords() - 1] &= lastWord;
+            }
+        });
+        std::swap(current, next);
+    }
+    if (current != &plane)
+    {
+        plane = std::move(*current);
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef TERRAGEN_AUTOMATON_HPP
+#define TERRAGEN_AUTOMATON_HPP
+
+#include "bitplane.hpp"
+#include "vector_2.hpp"
+#include <cstdint>
+
+// Birth/survival cellular automaton over a bitplane, used to smooth noise caves.
+//
+// Neighbour counts are bit-sliced: the eight shifted neighbour words are summed with a carry-save adder tree into
+// four count words, so 64 cells are counted and updated with a handful of word operations. Steps ping-pong between
+// two planes, and rows of a step are updated in parallel.
+namespace Automaton
+{
+// Bit n set: a dead cell with n live neighbours comes alive (birth) or a live one stays alive (survival)
+struct Rule
+{
+    std::uint16_t birth;
+    std::uint16_t survival;
+};
+
+// Runs the given number of steps over the half-open rows; rows outside are read as they are but never change.
+// Cells outside the plane count as live when outside is set
+void Run(Bitplane& plane, Rule rule, int steps, Vector2<int> rows, bool outside);
+}    // namespace Automaton
+
+#endif    // TERRAGEN_AUTOMATON_HPP
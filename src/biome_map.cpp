@@ -0,0 +1,74 @@
+#include "biome_map.hpp"
+#include <algorithm>
+
+BiomeMap::BiomeMap(int width, int height)
+    : m_columns{(width + CELL_SIZE - 1) >> CELL_SHIFT}, m_rows{(height + CELL_SIZE - 1) >> CELL_SHIFT},
+      m_ids(static_cast<std::size_t>(m_columns) * m_rows, Biome::Forest),
+      m_weights(static_cast<std::size_t>(m_columns) * m_rows * BIOME_COUNT, 0)
+{
+    std::fill_n(m_weights.begin(), m_ids.size(), FULL);
+}
+
+void BiomeMap::Composite(std::size_t cell, Biome biome, double coverage)
+{
+    const double keep = 1 - std::clamp(coverage, 0.0, 1.0);
+    const std::size_t cells = m_ids.size();
+    // The other biomes fade by the coverage and the painted one takes whatever they gave up, so the sum stays FULL
+    int others = 0;
+    for (int b = 0; b < BIOME_COUNT; ++b)
+    {
+        if (b != static_cast<int>(biome))
+        {
+            std::uint8_t& weight = m_weights[b * cells + cell];
+            weight = static_cast<std::uint8_t>(weight * keep + 0.5);
+            others += weight;
+        }
+    }
+    m_weights[static_cast<std::size_t>(biome) * cells + cell] = static_cast<std::uint8_t>(FULL - others);
+
+    int strongest = 0;
+    for (int b = 1; b < BIOME_COUNT; ++b)
+    {
+        if (m_weights[b * cells + cell] > m_weights[strongest * cells + cell])
+        {
+            strongest = b;
+        }
+    }
+    m_ids[cell] = static_cast<Biome>(strongest);
+}
+
+BiomeMap::Biome BiomeMap::At(int x, int y) const
+{
+    return m_ids[(x >> CELL_SHIFT) + static_cast<std::size_t>(m_columns) * (y >> CELL_SHIFT)];
+}
+
+double BiomeMap::Weight(Biome biome, int x, int y) const
+{
+    const std::uint8_t* plane = &m_weights[static_cast<std::size_t>(biome) * m_ids.size()];
+    // Position relative to the centre of the first cell: the cell centres either side of the tile, and how far it
+    // is from the first towards the second in 1/CELL_SIZE steps. Past the outer centres both sides clamp to the edge
+    const int gx = x - CELL_SIZE / 2;
+    const int gy = y - CELL_SIZE / 2;
+    const int left = std::clamp(gx >> CELL_SHIFT, 0, m_columns - 1);
+    const int right = std::clamp((gx >> CELL_SHIFT) + 1, 0, m_columns - 1);
+    const int top = std::clamp(gy >> CELL_SHIFT, 0, m_rows - 1);
+    const int bottom = std::clamp((gy >> CELL_SHIFT) + 1, 0, m_rows - 1);
+    const int fx = gx & (CELL_SIZE - 1);
+    const int fy = gy & (CELL_SIZE - 1);
+
+    const std::uint8_t* upper = &plane[static_cast<std::size_t>(m_columns) * top];
+    const std::uint8_t* lower = &plane[static_cast<std::size_t>(m_columns) * bottom];
+    const int above = upper[left] * (CELL_SIZE - fx) + upper[right] * fx;
+    const int below = lower[left] * (CELL_SIZE - fx) + lower[right] * fx;
+    return static_cast<double>(above * (CELL_SIZE - fy) + below * fy) / (FULL * CELL_SIZE * CELL_SIZE);
+}
+
+int BiomeMap::GetColumns() const
+{
+    return m_columns;
+}
+
+int BiomeMap::GetRows() const
+{
+    return m_rows;
+}
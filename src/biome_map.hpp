@@ -0,0 +1,78 @@
+#ifndef TERRAGEN_BIOME_MAP_HPP
+#define TERRAGEN_BIOME_MAP_HPP
+
+#include "parallel.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Which biome every part of the world belongs to, on a coarse grid of CELL_SIZE x CELL_SIZE tile cells.
+//
+// Every cell has a weight out of FULL for each biome and the id of its strongest one. Biome passes paint their shape
+// once per cell, so nothing recomputes biome geometry per tile. Tiles look their biome up with a shift and an index,
+// and get smooth blend weights by bilinear interpolation between the four nearest cell centres, with clamped indices
+// instead of edge branches.
+class BiomeMap
+{
+  public:
+    enum class Biome : std::uint8_t
+    {
+        Forest,
+        Snow,
+        Desert,
+        Jungle,
+        Marble,
+        Granite,
+        Mushroom,
+        Corruption,
+        Crimson,
+        Ocean,
+    };
+    static constexpr int BIOME_COUNT = 10;
+    static constexpr int CELL_SHIFT = 4;
+    static constexpr int CELL_SIZE = 1 << CELL_SHIFT;
+    static constexpr int FULL = 255;
+
+  private:
+    int m_columns;
+    int m_rows;
+    // Strongest biome of every cell
+    std::vector<Biome> m_ids;
+    // One plane of cell weights per biome, each cell's weights adding up to FULL
+    std::vector<std::uint8_t> m_weights;
+
+    // Lays the biome over the cell with the given coverage, like alpha blending
+    void Composite(std::size_t cell, Biome biome, double coverage);
+
+  public:
+    // Everything starts out as Forest
+    BiomeMap(int width, int height);
+
+    // Paints a biome over the map. coverage(x, y) is called once per cell with the tile at the cell's centre and
+    // returns how much of the cell the biome takes, from 0 to 1. Cells are painted in parallel.
+    template <class Coverage>
+    void Paint(Biome biome, Coverage coverage)
+    {
+        constexpr std::size_t ROWS_PER_TASK = 4;
+        Parallel::ForRange(m_rows, ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t row = begin; row < end; ++row)
+            {
+                for (int column = 0; column < m_columns; ++column)
+                {
+                    const int x = column * CELL_SIZE + CELL_SIZE / 2;
+                    const int y = static_cast<int>(row) * CELL_SIZE + CELL_SIZE / 2;
+                    Composite(row * m_columns + column, biome, coverage(x, y));
+                }
+            }
+        });
+    }
+
+    // Strongest biome of the tile's cell
+    [[nodiscard]] Biome At(int x, int y) const;
+    // Weight of the biome at the tile from 0 to 1, interpolated between cell centres
+    [[nodiscard]] double Weight(Biome biome, int x, int y) const;
+    [[nodiscard]] int GetColumns() const;
+    [[nodiscard]] int GetRows() const;
+};
+
+#endif    // TERRAGEN_BIOME_MAP_HPP
@@ -0,0 +1,106 @@
+#include "bitplane.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+constexpr int WORD_BITS = 64;
+constexpr std::size_t ROWS_PER_TASK = 16;
+constexpr std::uint64_t ALL = ~std::uint64_t{0};
+
+// Bit set for every tile the test passes, row by row in parallel
+template <class Test>
+Bitplane Build(const std::vector<Tile>& tiles, int width, int height, Test test)
+{
+    Bitplane plane{width, height};
+    Parallel::ForRange(height, ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t y = begin; y < end; ++y)
+        {
+            const Tile* row = &tiles[y * width];
+            std::uint64_t* bits = plane.Row(static_cast<int>(y));
+            for (int x = 0; x < width; ++x)
+            {
+                if (test(row[x]))
+                {
+                    bits[x / WORD_BITS] |= std::uint64_t{1} << (x % WORD_BITS);
+                }
+            }
+        }
+    });
+    return plane;
+}
+}    // namespace
+
+Bitplane::Bitplane(int width, int height)
+    : m_width{width}, m_height{height}, m_words{(width + WORD_BITS - 1) / WORD_BITS},
+      m_bits(static_cast<std::size_t>(m_words) * height, 0)
+{
+}
+
+Bitplane Bitplane::FromTypes(const std::vector<Tile>& tiles, int width, int height, TileTraits::TypeSet types)
+{
+    return Build(tiles, width, height, [types](const Tile& tile) { return TileTraits::InSet(tile.m_type, types); });
+}
+
+Bitplane Bitplane::FromLiquids(const std::vector<Tile>& tiles, int width, int height)
+{
+    return Build(tiles, width, height, [](const Tile& tile) { return tile.m_liquid != Tile::Liquid::None; });
+}
+
+int Bitplane::GetWidth() const
+{
+    return m_width;
+}
+
+int Bitplane::GetHeight() const
+{
+    return m_height;
+}
+
+int Bitplane::GetWords() const
+{
+    return m_words;
+}
+
+bool Bitplane::Get(int x, int y) const
+{
+    return ((Row(y)[x / WORD_BITS] >> (x % WORD_BITS)) & 1U) != 0;
+}
+
+std::uint64_t* Bitplane::Row(int y)
+{
+    return &m_bits[static_cast<std::size_t>(m_words) * y];
+}
+
+const std::uint64_t* Bitplane::Row(int y) const
+{
+    return &m_bits[static_cast<std::size_t>(m_words) * y];
+}
+
+std::uint64_t Bitplane::Word(int word, int y, bool outside) const
+{
+    if (y < 0 || y >= m_height || word < 0 || word >= m_words)
+    {
+        return outside ? ALL : 0;
+    }
+    const std::uint64_t bits = Row(y)[word];
+    const int used = m_width - word * WORD_BITS;
+    if (!outside || used >= WORD_BITS)
+    {
+        return bits;
+    }
+    return bits | (ALL << used);
+}
+
+std::uint64_t Bitplane::Shifted(int word, int y, int dx, bool outside) const
+{
+    const std::uint64_t bits = Word(word, y, outside);
+    if (dx < 0)
+    {
+        return (bits << 1) | (Word(word - 1, y, outside) >> (WORD_BITS - 1));
+    }
+    if (dx > 0)
+    {
+        return (bits >> 1) | (Word(word + 1, y, outside) << (WORD_BITS - 1));
+    }
+    return bits;
+}
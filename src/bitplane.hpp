@@ -0,0 +1,38 @@
+#ifndef TERRAGEN_BITPLANE_HPP
+#define TERRAGEN_BITPLANE_HPP
+
+#include "tile.hpp"
+#include "tile_traits.hpp"
+#include <cstdint>
+#include <vector>
+
+// One bit per tile, 64 columns to a word, so neighbourhood tests can look at a whole word of tiles at once.
+// Bit i of word w in a row is column 64 * w + i.
+class Bitplane
+{
+    int m_width;
+    int m_height;
+    int m_words;
+    std::vector<std::uint64_t> m_bits;
+
+  public:
+    Bitplane(int width, int height);
+    // Bit set for every tile whose type is in types, built row by row in parallel
+    static Bitplane FromTypes(const std::vector<Tile>& tiles, int width, int height, TileTraits::TypeSet types);
+    // Bit set for every tile holding any liquid
+    static Bitplane FromLiquids(const std::vector<Tile>& tiles, int width, int height);
+
+    [[nodiscard]] int GetWidth() const;
+    [[nodiscard]] int GetHeight() const;
+    [[nodiscard]] int GetWords() const;
+    [[nodiscard]] bool Get(int x, int y) const;
+    [[nodiscard]] std::uint64_t* Row(int y);
+    [[nodiscard]] const std::uint64_t* Row(int y) const;
+
+    // Word of row y, with every bit outside the plane (rows past the edges, columns past the width) set to outside
+    [[nodiscard]] std::uint64_t Word(int word, int y, bool outside) const;
+    // Word of row y moved dx columns (-1, 0 or 1), so bit i holds the tile at column 64 * word + i + dx
+    [[nodiscard]] std::uint64_t Shifted(int word, int y, int dx, bool outside) const;
+};
+
+#endif    // TERRAGEN_BITPLANE_HPP
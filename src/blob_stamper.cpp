@@ -0,0 +1,221 @@
+#include "blob_stamper.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+
+BlobStamper::BlobStamper(std::uint64_t seed, Mode mode) : m_seed{seed}, m_mode{mode}
+{
+}
+
+void BlobStamper::SetMode(Mode mode)
+{
+    m_mode = mode;
+}
+
+BlobStamper::Mode BlobStamper::GetMode() const
+{
+    return m_mode;
+}
+
+void BlobStamper::Stamp(std::vector<Tile>& tiles, int width, int height, const Blob& blob, Random& random)
+{
+    if (m_mode == Mode::Legacy)
+    {
+        StampLegacy(tiles, width, height, blob, random);
+        return;
+    }
+    Stamp(tiles, width, Clip{0, 0, width, height}, blob);
+}
+
+void BlobStamper::Stamp(std::vector<Tile>& tiles, int width, const Clip& clip, const Blob& blob)
+{
+    StampMasked(tiles, width, clip, blob, GetMask(blob.radius));
+}
+
+void BlobStamper::StampAll(std::vector<Tile>& tiles, int width, int height, const std::vector<Blob>& blobs)
+{
+    constexpr int BIN_SIZE = 64;
+
+    const int binsX = (width + BIN_SIZE - 1) / BIN_SIZE;
+    const int binsY = (height + BIN_SIZE - 1) / BIN_SIZE;
+    const auto binRange = [&](const Blob& blob, const Mask& mask) {
+        return Clip{
+            std::clamp((blob.x - mask.r) / BIN_SIZE, 0, binsX - 1),
+            std::clamp((blob.y - mask.r) / BIN_SIZE, 0, binsY - 1),
+            std::clamp((blob.x + mask.r - 1) / BIN_SIZE, 0, binsX - 1) + 1,
+            std::clamp((blob.y + mask.r - 1) / BIN_SIZE, 0, binsY - 1) + 1,
+        };
+    };
+
+    // Masks are looked up (and built) here, so the parallel part only ever reads the cache
+    std::vector<const Mask*> masks(blobs.size());
+    std::vector<std::uint32_t> offsets(static_cast<std::size_t>(binsX) * binsY + 1, 0);
+    for (std::size_t i = 0; i < blobs.size(); ++i)
+    {
+        masks[i] = &GetMask(blobs[i].radius);
+        const Clip range = binRange(blobs[i], *masks[i]);
+        for (int by = range.top; by < range.bottom; ++by)
+        {
+            for (int bx = range.left; bx < range.right; ++bx)
+            {
+                ++offsets[static_cast<std::size_t>(by) * binsX + bx + 1];
+            }
+        }
+    }
+    for (std::size_t bin = 1; bin < offsets.size(); ++bin)
+    {
+        offsets[bin] += offsets[bin - 1];
+    }
+    // Filled in blob order, so every bin lists its blobs in the order they would be stamped serially
+    std::vector<std::uint32_t> binned(offsets.back());
+    std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < blobs.size(); ++i)
+    {
+        const Clip range = binRange(blobs[i], *masks[i]);
+        for (int by = range.top; by < range.bottom; ++by)
+        {
+            for (int bx = range.left; bx < range.right; ++bx)
+            {
+                binned[cursor[static_cast<std::size_t>(by) * binsX + bx]++] = static_cast<std::uint32_t>(i);
+            }
+        }
+    }
+
+    Parallel::For(static_cast<std::size_t>(binsX) * binsY, [&](std::size_t bin) {
+        const int bx = static_cast<int>(bin % binsX);
+        const int by = static_cast<int>(bin / binsX);
+        const Clip clip{
+            bx * BIN_SIZE,
+            by * BIN_SIZE,
+            std::min((bx + 1) * BIN_SIZE, width),
+            std::min((by + 1) * BIN_SIZE, height),
+        };
+        for (std::uint32_t i = offsets[bin]; i < offsets[bin + 1]; ++i)
+        {
+            StampMasked(tiles, width, clip, blobs[binned[i]], *masks[binned[i]]);
+        }
+    });
+}
+
+void BlobStamper::StampMasked(
+    std::vector<Tile>& tiles, int width, const Clip& clip, const Blob& blob, const Mask& mask) const
+{
+    const float core = static_cast<float>(1 - blob.variation);
+    const double variation = blob.variation;
+    const std::uint64_t seed = Random::Hash(blob.x, blob.y, m_seed);
+
+    const int top = std::max(blob.y - mask.r, clip.top);
+    const int bottom = std::min(blob.y + mask.r, clip.bottom);
+    for (int y = top; y < bottom; ++y)
+    {
+        const Row& row = mask.rows[y - (blob.y - mask.r)];
+        const std::size_t base = row.offset + mask.r - blob.x;
+        Tile* line = &tiles[static_cast<std::size_t>(y) * width];
+
+        const auto fill = [&](int x) {
+            Tile& tile = line[x];
+            if (TileTraits::InSet(tile.m_type, blob.replace))
+            {
+                tile.m_type = blob.type;
+            }
+        };
+        // Same test as the legacy check, with the random value taken from a hash of the coordinate
+        const auto fillRing = [&](int x) {
+            if (mask.distances[base + x] + Random::HashDouble(x, y, seed) * variation < 1)
+            {
+                fill(x);
+            }
+        };
+
+        int left = std::max(blob.x + row.first, clip.left);
+        int right = std::min(blob.x + row.last, clip.right);
+        // Distance grows away from the center column, so the ring is only ever at the ends of the span
+        while (left < right && mask.distances[base + left] >= core)
+        {
+            fillRing(left++);
+        }
+        while (right > left && mask.distances[base + right - 1] >= core)
+        {
+            fillRing(--right);
+        }
+        for (int x = left; x < right; ++x)
+        {
+            fill(x);
+        }
+    }
+}
+
+const BlobStamper::Mask& BlobStamper::GetMask(double radius)
+{
+    constexpr double RADIUS_STEPS = 8;
+
+    const int key = static_cast<int>(std::lround(radius * RADIUS_STEPS));
+    if (const auto it = m_masks.find(key); it != m_masks.end())
+    {
+        return it->second;
+    }
+
+    const double quantized = key / RADIUS_STEPS;
+    const double half = quantized / 2;
+    const double halfSquared = half * half;
+
+    Mask mask;
+    mask.r = static_cast<int>(half);
+    const int side = mask.r * 2;
+    mask.rows.reserve(side);
+    mask.distances.resize(static_cast<std::size_t>(side) * side);
+    for (int dy = -mask.r; dy < mask.r; ++dy)
+    {
+        Row row{0, 0, static_cast<std::size_t>(dy + mask.r) * side};
+        bool inside = false;
+        for (int dx = -mask.r; dx < mask.r; ++dx)
+        {
+            const double squared = dx * dx + dy * dy;
+            mask.distances[row.offset + dx + mask.r] = static_cast<float>(std::sqrt(squared) / half);
+            if (squared < halfSquared)
+            {
+                if (!inside)
+                {
+                    row.first = dx;
+                    inside = true;
+                }
+                row.last = dx + 1;
+            }
+        }
+        mask.rows.push_back(row);
+    }
+
+    return m_masks.emplace(key, std::move(mask)).first->second;
+}
+
+void BlobStamper::StampLegacy(
+    std::vector<Tile>& tiles, int width, int height, const Blob& blob, Random& random) const
+{
+    const int x = blob.x;
+    const int y = blob.y;
+    const double radius = blob.radius;
+    const int r = static_cast<int>(radius / 2);
+    for (int i = x - r; i < x + r; ++i)
+    {
+        for (int j = y - r; j < y + r; ++j)
+        {
+            double distance = std::sqrt(std::pow(i - x, 2) + std::pow(j - y, 2));
+            distance *= 2 / radius;
+            // Drawn even for clipped cells so the random sequence matches the original FillBlob
+            double rand = random.GetDouble(0, blob.variation);
+            if (i < 0 || i >= width || j < 0 || j >= height)
+            {
+                continue;
+            }
+
+            // Distance is the distance from 0 (center) to 1 (max radius)
+            // Rand is a random value based on variation
+            double check = distance + rand;
+            Tile& tile = tiles[i + static_cast<std::size_t>(width) * j];
+            if (check < 1 && TileTraits::InSet(tile.m_type, blob.replace))
+            {
+                tile.m_type = blob.type;
+            }
+        }
+    }
+}
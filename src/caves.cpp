@@ -0,0 +1,206 @@
+#include "caves.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+// Strip width in columns. Fixed, so ids do not depend on the machine
+constexpr int STRIP_COLUMNS = 256;
+// Rows per task when writing the final ids
+constexpr std::size_t RELABEL_ROWS = 32;
+constexpr std::uint32_t NOT_OPEN = 0xFFFFFFFF;
+// Set on entries that hold a strip-local component number instead of a parent tile
+constexpr std::uint32_t NUMBERED = 0x80000000;
+
+// Statistics of one component within one strip
+struct Partial
+{
+    std::size_t area;
+    int left;
+    int top;
+    int right;
+    int bottom;
+    std::int64_t rowSum;
+};
+
+// Roots are always the smallest index of their set, so parents never point forward
+std::uint32_t FindRoot(std::vector<std::uint32_t>& parents, std::uint32_t i)
+{
+    while (parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+void Union(std::vector<std::uint32_t>& parents, std::uint32_t a, std::uint32_t b)
+{
+    a = FindRoot(parents, a);
+    b = FindRoot(parents, b);
+    if (a != b)
+    {
+        parents[std::max(a, b)] = std::min(a, b);
+    }
+}
+
+// Labels the columns [left, right) on their own. Every open entry ends up as NUMBERED | its strip-local component
+void LabelStrip(
+    const std::vector<Tile>& tiles,
+    int width,
+    int height,
+    TileTraits::TypeSet open,
+    int left,
+    int right,
+    std::vector<std::uint32_t>& entries,
+    std::vector<Partial>& partials)
+{
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = left; x < right; ++x)
+        {
+            const auto i = static_cast<std::uint32_t>(x + static_cast<std::size_t>(width) * y);
+            if (!TileTraits::InSet(tiles[i].m_type, open))
+            {
+                entries[i] = NOT_OPEN;
+                continue;
+            }
+            entries[i] = i;
+            if (x > left && entries[i - 1] != NOT_OPEN)
+            {
+                Union(entries, i, i - 1);
+            }
+            if (y > 0 && entries[i - width] != NOT_OPEN)
+            {
+                Union(entries, i, i - width);
+            }
+        }
+    }
+
+    // Parents come earlier in the scan than their children, so a root is numbered before the rest of its component
+    // and every other tile finds its number one step up
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = left; x < right; ++x)
+        {
+            const std::size_t i = x + static_cast<std::size_t>(width) * y;
+            const std::uint32_t parent = entries[i];
+            if (parent == NOT_OPEN)
+            {
+                continue;
+            }
+            std::uint32_t number;
+            if (parent == i)
+            {
+                number = static_cast<std::uint32_t>(partials.size());
+                partials.push_back(Partial{0, x, y, x + 1, y + 1, 0});
+            }
+            else
+            {
+                number = entries[parent] & ~NUMBERED;
+            }
+            entries[i] = NUMBERED | number;
+
+            Partial& partial = partials[number];
+            ++partial.area;
+            partial.left = std::min(partial.left, x);
+            partial.right = std::max(partial.right, x + 1);
+            partial.bottom = y + 1;
+            partial.rowSum += y;
+        }
+    }
+}
+}    // namespace
+
+Caves::Labels Caves::Label(const std::vector<Tile>& tiles, int width, int height, TileTraits::TypeSet open)
+{
+    const int strips = (width + STRIP_COLUMNS - 1) / STRIP_COLUMNS;
+    Labels labels;
+    labels.ids.resize(static_cast<std::size_t>(width) * height);
+
+    std::vector<std::vector<Partial>> partials(strips);
+    Parallel::For(strips, [&](std::size_t strip) {
+        const int left = static_cast<int>(strip) * STRIP_COLUMNS;
+        LabelStrip(
+            tiles, width, height, open, left, std::min(left + STRIP_COLUMNS, width), labels.ids, partials[strip]);
+    });
+
+    // Strip-local components numbered one after another, and joined where they touch across a strip border
+    std::vector<std::uint32_t> bases(strips + 1, 0);
+    for (int strip = 0; strip < strips; ++strip)
+    {
+        bases[strip + 1] = bases[strip] + static_cast<std::uint32_t>(partials[strip].size());
+    }
+    std::vector<std::uint32_t> joined(bases.back());
+    std::iota(joined.begin(), joined.end(), 0);
+    for (int strip = 1; strip < strips; ++strip)
+    {
+        const int x = strip * STRIP_COLUMNS;
+        for (int y = 0; y < height; ++y)
+        {
+            const std::uint32_t a = labels.ids[x - 1 + static_cast<std::size_t>(width) * y];
+            const std::uint32_t b = labels.ids[x + static_cast<std::size_t>(width) * y];
+            if (a != NOT_OPEN && b != NOT_OPEN)
+            {
+                Union(joined, bases[strip - 1] + (a & ~NUMBERED), bases[strip] + (b & ~NUMBERED));
+            }
+        }
+    }
+
+    std::vector<std::uint32_t> finalIds(bases.back());
+    std::vector<std::int64_t> rowSums;
+    for (int strip = 0; strip < strips; ++strip)
+    {
+        for (std::uint32_t local = 0; local < partials[strip].size(); ++local)
+        {
+            const std::uint32_t number = bases[strip] + local;
+            const std::uint32_t root = FindRoot(joined, number);
+            const Partial& partial = partials[strip][local];
+            if (root == number)
+            {
+                finalIds[number] = static_cast<std::uint32_t>(labels.components.size() + 1);
+                labels.components.push_back(Component{
+                    finalIds[number],
+                    0,
+                    Vector2<int>{partial.left, partial.right},
+                    Vector2<int>{partial.top, partial.bottom},
+                    0,
+                });
+                rowSums.push_back(0);
+            }
+            else
+            {
+                finalIds[number] = finalIds[root];
+            }
+
+            Component& component = labels.components[finalIds[number] - 1];
+            component.area += partial.area;
+            component.horizontal.x = std::min(component.horizontal.x, partial.left);
+            component.horizontal.y = std::max(component.horizontal.y, partial.right);
+            component.vertical.x = std::min(component.vertical.x, partial.top);
+            component.vertical.y = std::max(component.vertical.y, partial.bottom);
+            rowSums[finalIds[number] - 1] += partial.rowSum;
+        }
+    }
+    for (Component& component : labels.components)
+    {
+        component.depth = static_cast<int>(rowSums[component.id - 1] / static_cast<std::int64_t>(component.area));
+    }
+
+    Parallel::ForRange(height, RELABEL_ROWS, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t y = begin; y < end; ++y)
+        {
+            std::uint32_t* row = &labels.ids[y * width];
+            for (int strip = 0; strip < strips; ++strip)
+            {
+                const int right = std::min((strip + 1) * STRIP_COLUMNS, width);
+                for (int x = strip * STRIP_COLUMNS; x < right; ++x)
+                {
+                    row[x] = row[x] == NOT_OPEN ? 0 : finalIds[bases[strip] + (row[x] & ~NUMBERED)];
+                }
+            }
+        }
+    });
+    return labels;
+}
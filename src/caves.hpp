@@ -0,0 +1,40 @@
+#ifndef TERRAGEN_CAVES_HPP
+#define TERRAGEN_CAVES_HPP
+
+#include "tile.hpp"
+#include "tile_traits.hpp"
+#include "vector_2.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Connected-component labelling of open space, so passes can tell one cave from another.
+//
+// Tiles whose type is in the open set are joined with their four direct neighbours. The world is cut into strips of
+// columns that are labelled in parallel with a union-find, then the strips are stitched together along their borders.
+// Ids follow the strip layout, not the number of threads, so they are the same on every machine.
+namespace Caves
+{
+struct Component
+{
+    std::uint32_t id;
+    std::size_t area;
+    // Half-open bounding box
+    Vector2<int> horizontal;
+    Vector2<int> vertical;
+    // Mean row of the component's tiles, for choosing water or lava
+    int depth;
+};
+
+struct Labels
+{
+    // Component id of every tile, 0 for tiles that are not open
+    std::vector<std::uint32_t> ids;
+    // Indexed by id - 1
+    std::vector<Component> components;
+};
+
+Labels Label(const std::vector<Tile>& tiles, int width, int height, TileTraits::TypeSet open);
+}    // namespace Caves
+
+#endif    // TERRAGEN_CAVES_HPP
@@ -0,0 +1,108 @@
+#include "distance_field.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+constexpr std::size_t BLOCK_COLUMNS = 64;
+constexpr std::size_t ROWS_PER_TASK = 16;
+// Vertical distance of a column with no feature in it
+constexpr std::uint16_t NO_FEATURE = 0xFFFF;
+}    // namespace
+
+DistanceField::DistanceField(const std::vector<Tile>& tiles, int width, int height, TileTraits::TypeSet features)
+    : m_width{width}, m_distances(static_cast<std::size_t>(width) * height)
+{
+    // Vertical distance to the nearest feature in the same column. Blocks of columns walk their rows together so the
+    // sweeps read memory row by row
+    Parallel::ForRange(width, BLOCK_COLUMNS, [&](std::size_t begin, std::size_t end) {
+        const auto at = [&](std::size_t x, int y) -> std::uint16_t& {
+            return m_distances[x + static_cast<std::size_t>(width) * y];
+        };
+        const auto step = [](std::uint16_t distance) {
+            return distance == NO_FEATURE ? NO_FEATURE : static_cast<std::uint16_t>(distance + 1);
+        };
+        for (int y = 0; y < height; ++y)
+        {
+            for (std::size_t x = begin; x < end; ++x)
+            {
+                const bool feature = TileTraits::InSet(tiles[x + static_cast<std::size_t>(width) * y].m_type, features);
+                at(x, y) = feature ? 0 : y == 0 ? NO_FEATURE : step(at(x, y - 1));
+            }
+        }
+        for (int y = height - 2; y >= 0; --y)
+        {
+            for (std::size_t x = begin; x < end; ++x)
+            {
+                at(x, y) = std::min(at(x, y), step(at(x, y + 1)));
+            }
+        }
+    });
+
+    // Per row, the lower envelope of the parabolas (x - q)^2 + g(q)^2 over the columns q that have a feature
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    Parallel::ForRange(height, ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        std::vector<double> heights(width);
+        std::vector<int> vertices(width);
+        std::vector<double> bounds(static_cast<std::size_t>(width) + 1);
+        for (std::size_t y = begin; y < end; ++y)
+        {
+            std::uint16_t* row = &m_distances[y * width];
+            int count = 0;
+            for (int q = 0; q < width; ++q)
+            {
+                if (row[q] == NO_FEATURE)
+                {
+                    continue;
+                }
+                heights[q] = static_cast<double>(row[q]) * row[q];
+                const double base = heights[q] + static_cast<double>(q) * q;
+                double start = -INF;
+                while (count > 0)
+                {
+                    const int v = vertices[count - 1];
+                    start = (base - (heights[v] + static_cast<double>(v) * v)) / (2.0 * (q - v));
+                    if (start > bounds[count - 1])
+                    {
+                        break;
+                    }
+                    --count;
+                    start = -INF;
+                }
+                vertices[count] = q;
+                bounds[count] = start;
+                ++count;
+            }
+            if (count == 0)
+            {
+                std::fill(row, row + width, FAR);
+                continue;
+            }
+
+            bounds[count] = INF;
+            int k = 0;
+            for (int x = 0; x < width; ++x)
+            {
+                while (bounds[k + 1] < x)
+                {
+                    ++k;
+                }
+                const double dx = x - vertices[k];
+                const double distance = std::sqrt(dx * dx + heights[vertices[k]]) * STEPS_PER_TILE;
+                row[x] = distance >= FAR ? FAR : static_cast<std::uint16_t>(distance + 0.5);
+            }
+        }
+    });
+}
+
+double DistanceField::Get(int x, int y) const
+{
+    return static_cast<double>(GetRaw(x, y)) / STEPS_PER_TILE;
+}
+
+std::uint16_t DistanceField::GetRaw(int x, int y) const
+{
+    return m_distances[x + static_cast<std::size_t>(m_width) * y];
+}
@@ -0,0 +1,34 @@
+#ifndef TERRAGEN_DISTANCE_FIELD_HPP
+#define TERRAGEN_DISTANCE_FIELD_HPP
+
+#include "tile.hpp"
+#include "tile_traits.hpp"
+#include <cstdint>
+#include <vector>
+
+// Exact Euclidean distance from every tile to the nearest tile of a set of types, for falloffs and "near X" tests.
+//
+// Built in linear time in two separable passes (Meijster / Felzenszwalb): the vertical distance to the nearest feature
+// is swept down and up each column, then every row takes the lower envelope of the parabolas those distances span.
+// Column blocks and rows are both handled in parallel. Distances are stored as 16-bit fixed point.
+class DistanceField
+{
+  public:
+    // Fixed-point steps per tile of the stored distances
+    static constexpr int STEPS_PER_TILE = 8;
+    // Stored for tiles further than this, and for every tile when there are no features at all
+    static constexpr std::uint16_t FAR = 0xFFFF;
+
+    DistanceField(const std::vector<Tile>& tiles, int width, int height, TileTraits::TypeSet features);
+
+    // Distance in tiles, 0 on feature tiles
+    [[nodiscard]] double Get(int x, int y) const;
+    // Distance in 1/STEPS_PER_TILE tiles, rounded to nearest, or FAR
+    [[nodiscard]] std::uint16_t GetRaw(int x, int y) const;
+
+  private:
+    int m_width;
+    std::vector<std::uint16_t> m_distances;
+};
+
+#endif    // TERRAGEN_DISTANCE_FIELD_HPP
@@ -0,0 +1,131 @@
+#include "erosion.hpp"
+#include "parallel.hpp"
+#include "tile_traits.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+// Columns per strip of the tile variant; at least 2, so strips of the same parity never touch the same column
+constexpr int STRIP_COLUMNS = 32;
+constexpr std::size_t COLUMNS_PER_TASK = 256;
+constexpr TileTraits::Mask LOOSE = TileTraits::SOIL | TileTraits::GRAVITY;
+
+// Elevations grow upwards. flow[x] is what moves from column x to x + 1
+void Slump(std::vector<double>& elevation, const Erosion::Thermal& settings)
+{
+    const std::size_t n = elevation.size();
+    std::vector<double> flow(n, 0);
+    for (int step = 0; step < settings.steps; ++step)
+    {
+        for (std::size_t x = 0; x + 1 < n; ++x)
+        {
+            const double drop = elevation[x] - elevation[x + 1];
+            flow[x] = settings.rate * std::copysign(std::max(std::abs(drop) - settings.talus, 0.0), drop) / 2;
+        }
+        elevation[0] -= flow[0];
+        for (std::size_t x = 1; x < n; ++x)
+        {
+            elevation[x] += flow[x - 1] - flow[x];
+        }
+    }
+}
+
+void Wash(std::vector<double>& elevation, const Erosion::Hydraulic& settings)
+{
+    const std::size_t n = elevation.size();
+    std::vector<double> water(n, 0);
+    std::vector<double> sediment(n, 0);
+    std::vector<double> flow(n, 0);
+    std::vector<double> carried(n, 0);
+    for (int step = 0; step < settings.steps; ++step)
+    {
+        for (std::size_t x = 0; x < n; ++x)
+        {
+            water[x] += settings.rain;
+        }
+        // Water evens out the water surface, giving up at most half of what a column holds each way, and sediment
+        // goes along in proportion
+        for (std::size_t x = 0; x + 1 < n; ++x)
+        {
+            const double drop = (elevation[x] + water[x]) - (elevation[x + 1] + water[x + 1]);
+            flow[x] = std::clamp(drop / 2, -water[x + 1] / 2, water[x] / 2);
+            carried[x] = flow[x] * (flow[x] > 0 ? sediment[x] / water[x] : sediment[x + 1] / water[x + 1]);
+        }
+        for (std::size_t x = 0; x < n; ++x)
+        {
+            const double in = x > 0 ? flow[x - 1] : 0;
+            const double out = x + 1 < n ? flow[x] : 0;
+            water[x] += in - out;
+            sediment[x] += (x > 0 ? carried[x - 1] : 0) - (x + 1 < n ? carried[x] : 0);
+            // Running water picks ground up until it holds its capacity, slower water drops the excess
+            const double excess = sediment[x] - settings.capacity * (std::abs(in) + std::abs(out));
+            const double settled = excess * (excess > 0 ? settings.deposition : settings.erosion);
+            elevation[x] += settled;
+            sediment[x] -= settled;
+            water[x] *= 1 - settings.evaporation;
+        }
+    }
+    for (std::size_t x = 0; x < n; ++x)
+    {
+        elevation[x] += sediment[x];
+    }
+}
+}    // namespace
+
+void Erosion::ErodeProfile(std::vector<double>& rows, const Thermal& thermal, const Hydraulic& hydraulic)
+{
+    // Rows grow downwards, elevations upwards
+    std::transform(rows.begin(), rows.end(), rows.begin(), std::negate<>{});
+    Slump(rows, thermal);
+    Wash(rows, hydraulic);
+    std::transform(rows.begin(), rows.end(), rows.begin(), std::negate<>{});
+}
+
+void Erosion::ErodeTiles(std::vector<Tile>& tiles, int width, int rows, int talus, int steps)
+{
+    const auto at = [&](int x, int y) -> Tile& { return tiles[x + static_cast<std::size_t>(width) * y]; };
+    const auto ground = [&](int x, int y) {
+        while (y < rows && !TileTraits::HasAny(at(x, y).m_type, TileTraits::SOLID))
+        {
+            ++y;
+        }
+        return y;
+    };
+
+    // Top solid row of every column in the region, or rows when there is none
+    std::vector<int> tops(width);
+    Parallel::ForRange(width, COLUMNS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t x = begin; x < end; ++x)
+        {
+            tops[x] = ground(static_cast<int>(x), 0);
+        }
+    });
+
+    const int strips = (width + STRIP_COLUMNS - 1) / STRIP_COLUMNS;
+    for (int step = 0; step < steps; ++step)
+    {
+        for (int parity = 0; parity < 2; ++parity)
+        {
+            Parallel::For((strips + 1 - parity) / 2, [&](std::size_t i) {
+                const int begin = (static_cast<int>(i) * 2 + parity) * STRIP_COLUMNS;
+                for (int x = begin; x < std::min(begin + STRIP_COLUMNS, width); ++x)
+                {
+                    for (const int nx : {x - 1, x + 1})
+                    {
+                        if (nx < 0 || nx >= width || tops[x] >= rows || tops[nx] >= rows ||
+                            tops[nx] - tops[x] <= talus || !TileTraits::HasAny(at(x, tops[x]).m_type, LOOSE))
+                        {
+                            continue;
+                        }
+                        // The top block slides off onto the lower neighbour
+                        at(nx, --tops[nx]).m_type = at(x, tops[x]).m_type;
+                        at(x, tops[x]).m_type = Tile::Type::Air;
+                        tops[x] = ground(x, tops[x] + 1);
+                    }
+                }
+            });
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef TERRAGEN_EROSION_HPP
+#define TERRAGEN_EROSION_HPP
+
+#include "tile.hpp"
+#include <vector>
+
+// Erosion that wears the random-walk artifacts (spikes, cliffs, flat-topped steps) off the terrain.
+//
+// Profiles (one ground row per column) get thermal and hydraulic erosion. Thermal erosion slumps material off any
+// slope steeper than the talus onto the lower side. The hydraulic pass rains on the profile, lets water run towards the
+// lower water surface, and has moving water pick up ground and still water drop it. Every step computes the flow over
+// each pair of neighbours from the previous step, then applies it, so the loops are branch-free and vectorize across
+// the width, and material is only ever moved, never lost.
+//
+// The tile variant slumps loose surface blocks (soil and falling blocks) in the top rows of the grid onto much lower
+// neighbouring columns. Columns are split into strips, and even and odd strips take turns in parallel, so no two tasks
+// touch the same column.
+namespace Erosion
+{
+struct Thermal
+{
+    // Steepest slope left alone, in rows per column
+    double talus;
+    // Share of the excess slope moved per step, at most 0.5
+    double rate;
+    int steps;
+};
+
+struct Hydraulic
+{
+    // Water added to every column per step
+    double rain;
+    // Sediment moving water can hold per unit of flow
+    double capacity;
+    // Share of the missing or excess sediment picked up or dropped per step
+    double erosion;
+    double deposition;
+    // Share of the water lost per step
+    double evaporation;
+    int steps;
+};
+
+// Erodes a profile of ground rows in place
+void ErodeProfile(std::vector<double>& rows, const Thermal& thermal, const Hydraulic& hydraulic);
+
+// Slumps loose blocks off columns more than talus rows above a neighbour, over the rows [0, rows)
+void ErodeTiles(std::vector<Tile>& tiles, int width, int rows, int talus, int steps);
+}    // namespace Erosion
+
+#endif    // TERRAGEN_EROSION_HPP
@@ -0,0 +1,113 @@
+#include "flood_fill.hpp"
+#include "tile_traits.hpp"
+#include <algorithm>
+#include <utility>
+
+FloodFill::Result FloodFill::Fill(
+    std::vector<Tile>& tiles, int width, int height, Vector2<int> seed, Tile::Liquid liquid, double volume)
+{
+    const auto at = [&](int x, int y) -> Tile& { return tiles[x + static_cast<std::size_t>(width) * y]; };
+    const auto open = [&](int x, int y) {
+        const Tile& tile = at(x, y);
+        return !TileTraits::HasAny(tile.m_type, TileTraits::SOLID) && tile.m_liquid == Tile::Liquid::None;
+    };
+    // Liquid in an open tile stays put when there is a block or more liquid under it
+    const auto supported = [&](int x, int y) {
+        if (y + 1 >= height)
+        {
+            return true;
+        }
+        const Tile& below = at(x, y + 1);
+        return TileTraits::HasAny(below.m_type, TileTraits::SOLID) || below.m_liquid != Tile::Liquid::None;
+    };
+    // Widens the run through x sideways to a half-open span, or returns false at a spill point
+    const auto widen = [&](int x, int y, Vector2<int>& span) {
+        span = Vector2<int>{x, x + 1};
+        while (span.x > 0 && open(span.x - 1, y))
+        {
+            if (!supported(--span.x, y))
+            {
+                return false;
+            }
+        }
+        while (span.y < width && open(span.y, y))
+        {
+            if (!supported(span.y++, y))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    Result result{0, -1, false};
+    if (seed.x < 0 || seed.x >= width || seed.y < 0 || seed.y >= height || !open(seed.x, seed.y))
+    {
+        return result;
+    }
+    int y = seed.y;
+    while (!supported(seed.x, y))
+    {
+        ++y;
+    }
+
+    std::vector<Vector2<int>> level(1);
+    std::vector<Vector2<int>> next;
+    if (!widen(seed.x, y, level.front()))
+    {
+        result.spilled = true;
+        return result;
+    }
+    while (volume > 0)
+    {
+        int count = 0;
+        for (const Vector2<int>& span : level)
+        {
+            count += span.y - span.x;
+        }
+        const double amount = std::min(1.0, volume / count);
+        for (const Vector2<int>& span : level)
+        {
+            for (int x = span.x; x < span.y; ++x)
+            {
+                at(x, y).m_liquid = liquid;
+                at(x, y).m_liquidLevel = amount;
+            }
+        }
+        volume -= amount * count;
+        result.filled += amount * count;
+        result.surface = y;
+        if (amount < 1 || y == 0)
+        {
+            break;
+        }
+
+        // Spans come out left to right and disjoint: a run that an earlier span already widened over is skipped
+        next.clear();
+        --y;
+        for (const Vector2<int>& span : level)
+        {
+            for (int x = span.x; x < span.y; ++x)
+            {
+                if (!open(x, y) || (!next.empty() && x < next.back().y))
+                {
+                    continue;
+                }
+                Vector2<int> widened;
+                if (!widen(x, y, widened))
+                {
+                    result.spilled = true;
+                    return result;
+                }
+                next.push_back(widened);
+                x = widened.y;
+            }
+        }
+        if (next.empty())
+        {
+            break;
+        }
+        std::swap(level, next);
+    }
+    return result;
+}
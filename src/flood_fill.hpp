@@ -0,0 +1,31 @@
+#ifndef TERRAGEN_FLOOD_FILL_HPP
+#define TERRAGEN_FLOOD_FILL_HPP
+
+#include "tile.hpp"
+#include "vector_2.hpp"
+#include <vector>
+
+// Fills a basin with a fixed volume of liquid from the bottom up, for lakes and flooded jungle surface.
+//
+// The fill drops from the seed to the floor, then rises one row at a time. Each level is a list of spans: the open
+// runs directly above the spans of the level below, each widened sideways until it meets a wall. A tile in a new span
+// that has neither a block nor liquid under it is a spill point, where the liquid would run off, and the fill stops
+// below that level. Work and memory go with the number of spans and filled tiles, with nothing kept per tile.
+namespace FloodFill
+{
+struct Result
+{
+    // Volume placed, in full tiles
+    double filled;
+    // Row of the highest level that got any liquid, or -1 when nothing was placed
+    int surface;
+    // True when the fill stopped at a spill point rather than running out of volume or room
+    bool spilled;
+};
+
+// Fills the basin under the seed tile with up to volume tiles of liquid. Only m_liquid and m_liquidLevel of open tiles
+// without liquid are written; a top level that cannot be filled whole is filled evenly to a partial level
+Result Fill(std::vector<Tile>& tiles, int width, int height, Vector2<int> seed, Tile::Liquid liquid, double volume);
+}    // namespace FloodFill
+
+#endif    // TERRAGEN_FLOOD_FILL_HPP
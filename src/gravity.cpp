@@ -0,0 +1,56 @@
+#include "gravity.hpp"
+#include "parallel.hpp"
+#include "tile_traits.hpp"
+#include <algorithm>
+
+namespace
+{
+// Columns walked together; wide enough for whole cache lines per row, narrow enough to spread over threads
+constexpr std::size_t CHUNK_COLUMNS = 64;
+// No open row below in this column
+constexpr int NO_GAP = -1;
+}    // namespace
+
+void Gravity::Settle(std::vector<Tile>& tiles, int width, Vector2<int> horizontal, Vector2<int> vertical)
+{
+    const int left = std::max(horizontal.x, 0);
+    const int right = std::min(horizontal.y, width);
+    const int top = std::max(vertical.x, 0);
+    const int bottom = std::min(vertical.y, static_cast<int>(tiles.size() / width));
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
+
+    Parallel::ForRange(right - left, CHUNK_COLUMNS, [&](std::size_t begin, std::size_t end) {
+        const int first = left + static_cast<int>(begin);
+        const int count = static_cast<int>(end - begin);
+        std::vector<int> gaps(count, NO_GAP);
+        for (int y = bottom - 1; y >= top; --y)
+        {
+            Tile* row = &tiles[static_cast<std::size_t>(width) * y + first];
+            for (int i = 0; i < count; ++i)
+            {
+                const Tile::Type type = row[i].m_type;
+                if (type == Tile::Type::Air)
+                {
+                    if (gaps[i] == NO_GAP)
+                    {
+                        gaps[i] = y;
+                    }
+                }
+                else if (!TileTraits::HasAny(type, TileTraits::GRAVITY))
+                {
+                    gaps[i] = NO_GAP;
+                }
+                else if (gaps[i] != NO_GAP)
+                {
+                    // Everything between the gap and this block is air, so the next open row is just above the gap
+                    tiles[static_cast<std::size_t>(width) * gaps[i] + first + i].m_type = type;
+                    row[i].m_type = Tile::Type::Air;
+                    --gaps[i];
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,20 @@
+#ifndef TERRAGEN_GRAVITY_HPP
+#define TERRAGEN_GRAVITY_HPP
+
+#include "tile.hpp"
+#include "vector_2.hpp"
+#include <vector>
+
+// Settles blocks with the GRAVITY trait (sand, silt, slush) straight down through air, as if they had all fallen.
+//
+// Each column is compacted bottom up in one pass: the lowest open row of the current air run is remembered, and
+// every falling block found above it moves there. Only the tile type moves; walls and liquids stay where they are.
+// Columns are handled in chunks that walk their rows together, so memory is read row by row, and chunks run in
+// parallel.
+namespace Gravity
+{
+// Settles the half-open region. Its bottom row is treated as the floor: nothing falls out of the region
+void Settle(std::vector<Tile>& tiles, int width, Vector2<int> horizontal, Vector2<int> vertical);
+}    // namespace Gravity
+
+#endif    // TERRAGEN_GRAVITY_HPP
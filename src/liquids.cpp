@@ -0,0 +1,237 @@
+#include "liquids.hpp"
+#include "parallel.hpp"
+#include "tile_traits.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+// Strip width in columns; at least 2, so strips of the same parity never touch the same cell
+constexpr int STRIP_COLUMNS = 32;
+// Rows per chunk when collecting the initial active cells
+constexpr std::size_t COLLECT_ROWS = 64;
+// Cells left with less liquid than this dry up
+constexpr double MIN_LEVEL = 0.01;
+// Level differences smaller than this are not worth evening out
+constexpr double SPREAD_EPSILON = 0.005;
+
+class Solver
+{
+    std::vector<Tile>& m_tiles;
+    int m_width;
+    int m_height;
+
+    static bool IsOpen(const Tile& tile)
+    {
+        return !TileTraits::HasAny(tile.m_type, TileTraits::SOLID);
+    }
+
+    static bool Accepts(const Tile& tile, Tile::Liquid liquid)
+    {
+        return IsOpen(tile) && (tile.m_liquid == Tile::Liquid::None || tile.m_liquid == liquid);
+    }
+
+    static void Set(Tile& tile, Tile::Liquid liquid, double level)
+    {
+        if (level < MIN_LEVEL)
+        {
+            tile.m_liquid = Tile::Liquid::None;
+            tile.m_liquidLevel = 0;
+            return;
+        }
+        tile.m_liquid = liquid;
+        tile.m_liquidLevel = level;
+    }
+
+    // A changed cell can move again itself, and the cells above and beside it may now flow into it
+    void Wake(std::vector<std::uint32_t>& woken, int x, int y) const
+    {
+        const auto cell = static_cast<std::uint32_t>(x + m_width * y);
+        woken.push_back(cell);
+        if (y > 0)
+        {
+            woken.push_back(cell - m_width);
+        }
+        if (x > 0)
+        {
+            woken.push_back(cell - 1);
+        }
+        if (x + 1 < m_width)
+        {
+            woken.push_back(cell + 1);
+        }
+    }
+
+  public:
+    Solver(std::vector<Tile>& tiles, int width, int height) : m_tiles{tiles}, m_width{width}, m_height{height}
+    {
+    }
+
+    void Step(std::uint32_t cell, std::vector<std::uint32_t>& woken)
+    {
+        const int x = static_cast<int>(cell % m_width);
+        const int y = static_cast<int>(cell / m_width);
+        Tile& tile = m_tiles[cell];
+        if (tile.m_liquid == Tile::Liquid::None)
+        {
+            return;
+        }
+        const Tile::Liquid liquid = tile.m_liquid;
+        if (!IsOpen(tile))
+        {
+            Set(tile, liquid, 0);
+            Wake(woken, x, y);
+            return;
+        }
+
+        double level = tile.m_liquidLevel;
+        if (y + 1 < m_height)
+        {
+            Tile& below = m_tiles[cell + m_width];
+            if (IsOpen(below) && below.m_liquid == Tile::Liquid::None)
+            {
+                // Falls through the whole open drop at once
+                int landing = y + 1;
+                while (landing + 1 < m_height && IsOpen(m_tiles[x + m_width * (landing + 1)]) &&
+                       m_tiles[x + m_width * (landing + 1)].m_liquid == Tile::Liquid::None)
+                {
+                    ++landing;
+                }
+                Set(m_tiles[x + m_width * landing], liquid, level);
+                Set(tile, liquid, 0);
+                Wake(woken, x, y);
+                Wake(woken, x, landing);
+                return;
+            }
+            if (Accepts(below, liquid) && below.m_liquidLevel < 1)
+            {
+                const double moved = std::min(level, 1 - below.m_liquidLevel);
+                Set(below, liquid, below.m_liquidLevel + moved);
+                level -= moved;
+                Set(tile, liquid, level);
+                Wake(woken, x, y);
+                Wake(woken, x, y + 1);
+                if (tile.m_liquid == Tile::Liquid::None)
+                {
+                    return;
+                }
+                level = tile.m_liquidLevel;
+            }
+        }
+
+        Tile* sides[2];
+        int count = 0;
+        double total = level;
+        for (const int side : {x - 1, x + 1})
+        {
+            if (side >= 0 && side < m_width && Accepts(m_tiles[side + m_width * y], liquid))
+            {
+                sides[count] = &m_tiles[side + m_width * y];
+                total += sides[count]->m_liquidLevel;
+                ++count;
+            }
+        }
+        if (count == 0)
+        {
+            return;
+        }
+        const double average = total / (count + 1);
+        bool uneven = std::abs(level - average) > SPREAD_EPSILON;
+        for (int i = 0; i < count; ++i)
+        {
+            uneven = uneven || std::abs(sides[i]->m_liquidLevel - average) > SPREAD_EPSILON;
+        }
+        if (!uneven)
+        {
+            return;
+        }
+        Set(tile, liquid, average);
+        Wake(woken, x, y);
+        for (int i = 0; i < count; ++i)
+        {
+            Set(*sides[i], liquid, average);
+            const int side = static_cast<int>(sides[i] - &m_tiles[m_width * y]);
+            Wake(woken, side, y);
+        }
+    }
+};
+
+std::vector<std::uint32_t> CollectLiquids(const std::vector<Tile>& tiles, int width, int height)
+{
+    const std::size_t chunks = (height + COLLECT_ROWS - 1) / COLLECT_ROWS;
+    std::vector<std::vector<std::uint32_t>> found(chunks);
+    Parallel::ForRange(height, COLLECT_ROWS, [&](std::size_t begin, std::size_t end) {
+        auto& cells = found[begin / COLLECT_ROWS];
+        for (std::size_t cell = begin * width; cell < end * width; ++cell)
+        {
+            if (tiles[cell].m_liquid != Tile::Liquid::None)
+            {
+                cells.push_back(static_cast<std::uint32_t>(cell));
+            }
+        }
+    });
+
+    std::vector<std::uint32_t> active;
+    for (const auto& cells : found)
+    {
+        active.insert(active.end(), cells.begin(), cells.end());
+    }
+    return active;
+}
+}    // namespace
+
+std::size_t Liquids::Settle(std::vector<Tile>& tiles, int width, int height, std::size_t maxSteps)
+{
+    Solver solver{tiles, width, height};
+    const int strips = (width + STRIP_COLUMNS - 1) / STRIP_COLUMNS;
+    std::vector<std::uint32_t> active = CollectLiquids(tiles, width, height);
+    std::vector<std::uint32_t> offsets(strips + 1);
+    std::vector<std::uint32_t> binned;
+    std::vector<std::vector<std::uint32_t>> woken(strips);
+
+    std::size_t steps = 0;
+    while (!active.empty() && steps < maxSteps)
+    {
+        ++steps;
+
+        // Active cells are sorted, so every strip lists its cells in index order
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (const std::uint32_t cell : active)
+        {
+            ++offsets[cell % width / STRIP_COLUMNS + 1];
+        }
+        for (int strip = 0; strip < strips; ++strip)
+        {
+            offsets[strip + 1] += offsets[strip];
+        }
+        binned.resize(active.size());
+        std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (const std::uint32_t cell : active)
+        {
+            binned[cursor[cell % width / STRIP_COLUMNS]++] = cell;
+        }
+
+        for (int parity = 0; parity < 2; ++parity)
+        {
+            Parallel::For((strips + 1 - parity) / 2, [&](std::size_t i) {
+                const std::size_t strip = i * 2 + parity;
+                // Bottom rows first, so liquid that lands on settled liquid sees it already in place
+                for (std::uint32_t j = offsets[strip + 1]; j > offsets[strip]; --j)
+                {
+                    solver.Step(binned[j - 1], woken[strip]);
+                }
+            });
+        }
+
+        active.clear();
+        for (auto& cells : woken)
+        {
+            active.insert(active.end(), cells.begin(), cells.end());
+            cells.clear();
+        }
+        std::sort(active.begin(), active.end());
+        active.erase(std::unique(active.begin(), active.end()), active.end());
+    }
+    return steps;
+}
@@ -0,0 +1,23 @@
+#ifndef TERRAGEN_LIQUIDS_HPP
+#define TERRAGEN_LIQUIDS_HPP
+
+#include "tile.hpp"
+#include <cstddef>
+#include <vector>
+
+// Settles liquids (m_liquid and m_liquidLevel) until nothing moves any more.
+//
+// Only active cells are updated: a cell is active when it or a neighbour changed in the previous step, so work
+// follows the liquid that is still flowing instead of the size of the world. A step falls liquid straight down onto
+// whatever is below it, tops up partly filled cells below, and evens out levels with the open cells to the left and
+// right. Films thinner than a minimum level evaporate, so every pool comes to rest.
+//
+// Each step splits the active cells into fixed strips of columns. A cell only touches its own column and the two next
+// to it, so all even strips run in parallel, then all odd strips. The result does not depend on the number of threads.
+namespace Liquids
+{
+// Returns the number of steps taken; stops early after maxSteps
+std::size_t Settle(std::vector<Tile>& tiles, int width, int height, std::size_t maxSteps);
+}    // namespace Liquids
+
+#endif    // TERRAGEN_LIQUIDS_HPP
@@ -0,0 +1,168 @@
+#include "parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+
+namespace
+{
+thread_local bool t_insideTask = false;
+
+class Pool
+{
+    std::vector<std::thread> m_threads;
+    std::mutex m_submit;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(std::size_t)>* m_task{nullptr};
+    std::size_t m_count{0};
+    std::atomic<std::size_t> m_next{0};
+    std::size_t m_generation{0};
+    std::size_t m_busy{0};
+    bool m_stop{false};
+
+    void Drain()
+    {
+        const bool wasInside = t_insideTask;
+        t_insideTask = true;
+        for (std::size_t i = m_next++; i < m_count; i = m_next++)
+        {
+            (*m_task)(i);
+        }
+        t_insideTask = wasInside;
+    }
+
+    void Work()
+    {
+        std::size_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock lock{m_mutex};
+                m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop)
+                {
+                    return;
+                }
+                seen = m_generation;
+            }
+            Drain();
+            {
+                std::lock_guard lock{m_mutex};
+                if (--m_busy == 0)
+                {
+                    m_done.notify_one();
+                }
+            }
+        }
+    }
+
+  public:
+    Pool()
+    {
+        const std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+        m_threads.reserve(threads - 1);
+        for (std::size_t i = 1; i < threads; ++i)
+        {
+            m_threads.emplace_back([this] { Work(); });
+        }
+    }
+    ~Pool()
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+    Pool(const Pool&) = delete;
+    Pool(Pool&&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    Pool& operator=(Pool&&) = delete;
+
+    [[nodiscard]] std::size_t Size() const
+    {
+        return m_threads.size() + 1;
+    }
+
+    void Run(std::size_t count, const std::function<void(std::size_t)>& task)
+    {
+        std::lock_guard submit{m_submit};
+        {
+            std::lock_guard lock{m_mutex};
+            m_task = &task;
+            m_count = count;
+            m_next = 0;
+            m_busy = m_threads.size();
+            ++m_generation;
+        }
+        m_wake.notify_all();
+        Drain();
+        std::unique_lock lock{m_mutex};
+        m_done.wait(lock, [&] { return m_busy == 0; });
+        m_task = nullptr;
+    }
+};
+
+Pool& GetPool()
+{
+    static Pool pool;
+    return pool;
+}
+}    // namespace
+
+std::size_t Parallel::ThreadCount()
+{
+    return GetPool().Size();
+}
+
+std::size_t Parallel::CacheSize()
+{
+    constexpr std::size_t FALLBACK = 512 * 1024;
+
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    static const long reported = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (reported > 0)
+    {
+        return static_cast<std::size_t>(reported);
+    }
+#endif
+    return FALLBACK;
+}
+
+void Parallel::For(std::size_t count, const std::function<void(std::size_t)>& task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (count == 1 || t_insideTask || ThreadCount() == 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            task(i);
+        }
+        return;
+    }
+    GetPool().Run(count, task);
+}
+
+void Parallel::ForRange(
+    std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& task)
+{
+    grain = std::max<std::size_t>(grain, 1);
+    For((count + grain - 1) / grain, [&](std::size_t chunk) {
+        const std::size_t begin = chunk * grain;
+        task(begin, std::min(begin + grain, count));
+    });
+}
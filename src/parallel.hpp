@@ -0,0 +1,21 @@
+#ifndef TERRAGEN_PARALLEL_HPP
+#define TERRAGEN_PARALLEL_HPP
+
+#include <cstddef>
+#include <functional>
+
+// Shared worker pool for data-parallel passes. Work is handed out in index order, but tasks must not depend on the
+// order they run in. Calls made from inside a task run inline on the calling thread.
+namespace Parallel
+{
+// Number of threads work is spread over, including the calling thread
+std::size_t ThreadCount();
+// Bytes of per-core (L2) cache, or a conservative guess where the platform does not report it
+std::size_t CacheSize();
+// Runs task(i) for every i in [0, count) and returns once all of them are done
+void For(std::size_t count, const std::function<void(std::size_t)>& task);
+// Runs task(begin, end) over consecutive chunks of [0, count) of at most grain indices each
+void ForRange(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& task);
+}    // namespace Parallel
+
+#endif    // TERRAGEN_PARALLEL_HPP
@@ -0,0 +1,147 @@
+#include "placement_index.hpp"
+#include <algorithm>
+#include <vector>
+
+PlacementIndex::PlacementIndex(int width) : m_width{width}
+{
+    m_surface.emplace(0, Tile::Type::Air);
+}
+
+void PlacementIndex::Occupy(int begin, int end)
+{
+    begin = std::max(begin, 0);
+    end = std::min(end, m_width);
+    if (begin >= end)
+    {
+        return;
+    }
+    // Merge with every run that touches [begin, end)
+    auto it = m_occupied.upper_bound(begin);
+    if (it != m_occupied.begin() && std::prev(it)->second >= begin)
+    {
+        --it;
+    }
+    while (it != m_occupied.end() && it->first <= end)
+    {
+        begin = std::min(begin, it->first);
+        end = std::max(end, it->second);
+        it = m_occupied.erase(it);
+    }
+    m_occupied.emplace(begin, end);
+}
+
+void PlacementIndex::SetSurface(int begin, int end, Tile::Type type)
+{
+    begin = std::max(begin, 0);
+    end = std::min(end, m_width);
+    if (begin >= end)
+    {
+        return;
+    }
+    const Tile::Type after = GetSurface(end);
+    m_surface.erase(m_surface.lower_bound(begin), m_surface.upper_bound(end));
+    if (end < m_width)
+    {
+        m_surface.emplace(end, after);
+    }
+    // Keep neighbouring runs of the same type merged, so the run count stays small
+    auto it = m_surface.emplace(begin, type).first;
+    if (it != m_surface.begin() && std::prev(it)->second == type)
+    {
+        it = m_surface.erase(it);
+        --it;
+    }
+    if (auto next = std::next(it); next != m_surface.end() && next->second == type)
+    {
+        m_surface.erase(next);
+    }
+}
+
+Tile::Type PlacementIndex::GetSurface(int x) const
+{
+    return std::prev(m_surface.upper_bound(std::max(x, 0)))->second;
+}
+
+std::optional<int> PlacementIndex::Sample(
+    Vector2<int> range, int size, TileTraits::TypeSet forbiddenEnds, Random& random) const
+{
+    // The whole structure, including its last column, has to fit in the world
+    const int lo = std::max(range.x, 0);
+    const int hi = std::min(range.y, m_width - 1 - size);
+    if (lo > hi)
+    {
+        return std::nullopt;
+    }
+
+    // Half-open ranges of start columns that are not allowed
+    std::vector<Vector2<int>> invalid;
+    // Occupied runs that overlap [start, start + size]
+    auto occupied = m_occupied.upper_bound(lo - size);
+    if (occupied != m_occupied.begin())
+    {
+        --occupied;
+    }
+    for (; occupied != m_occupied.end() && occupied->first <= hi + size; ++occupied)
+    {
+        invalid.push_back(Vector2<int>{occupied->first - size, occupied->second});
+    }
+    // Forbidden surface runs under either end column
+    if (forbiddenEnds != 0)
+    {
+        auto run = std::prev(m_surface.upper_bound(std::max(lo, 0)));
+        for (; run != m_surface.end() && run->first <= hi + size; ++run)
+        {
+            if (!TileTraits::InSet(run->second, forbiddenEnds))
+            {
+                continue;
+            }
+            const auto next = std::next(run);
+            const int end = next == m_surface.end() ? m_width : next->first;
+            invalid.push_back(Vector2<int>{run->first, end});
+            invalid.push_back(Vector2<int>{run->first - size, end - size});
+        }
+    }
+    std::sort(invalid.begin(), invalid.end(), [](const auto& a, const auto& b) { return a.x < b.x; });
+
+    // Complement within [lo, hi], as valid half-open ranges
+    std::vector<Vector2<int>> valid;
+    int total = 0;
+    int cursor = lo;
+    for (const Vector2<int>& blocked : invalid)
+    {
+        if (blocked.x > cursor)
+        {
+            const int end = std::min(blocked.x, hi + 1);
+            if (end > cursor)
+            {
+                valid.push_back(Vector2<int>{cursor, end});
+                total += end - cursor;
+            }
+        }
+        cursor = std::max(cursor, blocked.y);
+        if (cursor > hi)
+        {
+            break;
+        }
+    }
+    if (cursor <= hi)
+    {
+        valid.push_back(Vector2<int>{cursor, hi + 1});
+        total += hi + 1 - cursor;
+    }
+    if (total == 0)
+    {
+        return std::nullopt;
+    }
+
+    int pick = random.GetInt(0, total - 1);
+    for (const Vector2<int>& span : valid)
+    {
+        if (pick < span.y - span.x)
+        {
+            return span.x + pick;
+        }
+        pick -= span.y - span.x;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,37 @@
+#ifndef TERRAGEN_PLACEMENT_INDEX_HPP
+#define TERRAGEN_PLACEMENT_INDEX_HPP
+
+#include "random.hpp"
+#include "tile.hpp"
+#include "tile_traits.hpp"
+#include "vector_2.hpp"
+#include <map>
+#include <optional>
+
+// Tracks which columns of the surface are taken by structures (tunnels, deserts, anthills) and what type of tile
+// each column's surface is, as runs of columns. Valid start columns for a new structure are worked out from the
+// runs near the requested range and sampled uniformly, so placement never retries and cost does not grow with
+// the world width.
+class PlacementIndex
+{
+    int m_width;
+    // Begin -> end of each occupied run, disjoint
+    std::map<int, int> m_occupied;
+    // Begin of each surface run -> its type; a run ends where the next one starts
+    std::map<int, Tile::Type> m_surface;
+
+  public:
+    explicit PlacementIndex(int width);
+
+    // Marks columns [begin, end) as taken
+    void Occupy(int begin, int end);
+    // Records the surface type of columns [begin, end)
+    void SetSurface(int begin, int end, Tile::Type type);
+    [[nodiscard]] Tile::Type GetSurface(int x) const;
+
+    // Picks a start column in the inclusive range so that columns [start, start + size] are free and neither end
+    // column has a surface type in forbiddenEnds. Returns nothing when no such column exists.
+    std::optional<int> Sample(Vector2<int> range, int size, TileTraits::TypeSet forbiddenEnds, Random& random) const;
+};
+
+#endif    // TERRAGEN_PLACEMENT_INDEX_HPP
@@ -0,0 +1,96 @@
+#include "prefab.hpp"
+#include <algorithm>
+#include <array>
+#include <fmt/format.h>
+#include <stdexcept>
+
+Prefab::Prefab(const std::vector<std::string>& art, const std::vector<Key>& legend)
+    : m_width{art.empty() ? 0 : static_cast<int>(art.front().size())}, m_height{static_cast<int>(art.size())}
+{
+    constexpr int NO_KEY = -1;
+    std::array<int, 256> keys{};
+    keys.fill(NO_KEY);
+    for (std::size_t i = 0; i < legend.size(); ++i)
+    {
+        keys[static_cast<unsigned char>(legend[i].symbol)] = static_cast<int>(i);
+    }
+
+    const std::size_t area = static_cast<std::size_t>(m_width) * m_height;
+    m_types.resize(area, Tile::Type::Air);
+    m_walls.resize(area, Tile::Wall::Air);
+    m_liquids.resize(area, Tile::Liquid::None);
+    m_rows.reserve(m_height + 1);
+    m_rows.push_back(0);
+    for (int y = 0; y < m_height; ++y)
+    {
+        const std::string& row = art[y];
+        if (static_cast<int>(row.size()) != m_width)
+        {
+            throw std::runtime_error{fmt::format("prefab row {} is {} wide instead of {}", y, row.size(), m_width)};
+        }
+        for (int x = 0; x < m_width; ++x)
+        {
+            if (row[x] == TRANSPARENT)
+            {
+                continue;
+            }
+            const int key = keys[static_cast<unsigned char>(row[x])];
+            if (key == NO_KEY)
+            {
+                throw std::runtime_error{
+                    fmt::format("prefab symbol '{}' at {}, {} is not in the legend", row[x], x, y)};
+            }
+            const std::size_t i = x + static_cast<std::size_t>(m_width) * y;
+            m_types[i] = legend[key].type;
+            m_walls[i] = legend[key].wall;
+            m_liquids[i] = legend[key].liquid;
+            if (m_spans.size() > m_rows.back() && m_spans.back().y == x)
+            {
+                ++m_spans.back().y;
+            }
+            else
+            {
+                m_spans.push_back(Vector2<int>{x, x + 1});
+            }
+        }
+        m_rows.push_back(static_cast<std::uint32_t>(m_spans.size()));
+    }
+}
+
+int Prefab::GetWidth() const
+{
+    return m_width;
+}
+
+int Prefab::GetHeight() const
+{
+    return m_height;
+}
+
+void Prefab::Blit(
+    std::vector<Tile>& tiles, int width, int height, Vector2<int> position, bool flipX, bool flipY) const
+{
+    const int top = std::max(-position.y, 0);
+    const int bottom = std::min(m_height, height - position.y);
+    for (int py = top; py < bottom; ++py)
+    {
+        const int source = flipY ? m_height - 1 - py : py;
+        const std::size_t base = static_cast<std::size_t>(m_width) * source;
+        Tile* row = &tiles[static_cast<std::size_t>(width) * (position.y + py)];
+        for (std::uint32_t s = m_rows[source]; s < m_rows[source + 1]; ++s)
+        {
+            // Columns of the run once mirrored, then clipped to the world
+            const Vector2<int> span = flipX ? Vector2<int>{m_width - m_spans[s].y, m_width - m_spans[s].x} : m_spans[s];
+            const int left = std::max(position.x + span.x, 0);
+            const int right = std::min(position.x + span.y, width);
+            for (int x = left; x < right; ++x)
+            {
+                const int px = x - position.x;
+                const std::size_t i = base + (flipX ? m_width - 1 - px : px);
+                row[x].m_type = m_types[i];
+                row[x].m_wall = m_walls[i];
+                row[x].SetLiquid(m_liquids[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef TERRAGEN_PREFAB_HPP
+#define TERRAGEN_PREFAB_HPP
+
+#include "tile.hpp"
+#include "vector_2.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Pre-authored tile pattern (dungeon rooms, temples, pyramids, sky-island houses, hives) stamped into the world.
+//
+// A prefab keeps one byte plane each for types, walls and liquids, and its transparency mask as the opaque runs of
+// every row, so blitting is a span copy per run with no per-tile transparency test. Prefabs never change once built:
+// keep each in a function-local static so it is built once and shared read-only by every generator and thread.
+class Prefab
+{
+  public:
+    // What one symbol of the art stands for
+    struct Key
+    {
+        char symbol;
+        Tile::Type type;
+        Tile::Wall wall;
+        Tile::Liquid liquid;
+    };
+    // Symbol of tiles the prefab leaves as they are
+    static constexpr char TRANSPARENT = ' ';
+
+  private:
+    int m_width;
+    int m_height;
+    std::vector<Tile::Type> m_types;
+    std::vector<Tile::Wall> m_walls;
+    std::vector<Tile::Liquid> m_liquids;
+    // Opaque runs as half-open column ranges; row y's are m_spans[m_rows[y]] up to m_spans[m_rows[y + 1]]
+    std::vector<Vector2<int>> m_spans;
+    std::vector<std::uint32_t> m_rows;
+
+  public:
+    // One string per row, all the same length, one symbol per tile. Throws on ragged rows and unknown symbols
+    Prefab(const std::vector<std::string>& art, const std::vector<Key>& legend);
+
+    [[nodiscard]] int GetWidth() const;
+    [[nodiscard]] int GetHeight() const;
+
+    // Copies the opaque tiles into the world with the prefab's top left corner at position, after mirroring it
+    // left to right and/or top to bottom, clipped to the world
+    void Blit(std::vector<Tile>& tiles, int width, int height, Vector2<int> position, bool flipX, bool flipY) const;
+};
+
+#endif    // TERRAGEN_PREFAB_HPP
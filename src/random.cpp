@@ -1,4 +1,5 @@
 #include "random.hpp"
+#include <limits>
 #include <random>
 
 Random::Random(std::uint64_t seed) : m_eng{seed}, m_randomModifier{seed}
@@ -30,6 +31,19 @@ int Random::GetInt(const Vector2<int> minMax)
     return GetInt(minMax.x, minMax.y);
 }
 
+std::int64_t Random::GetGeometric(const double chance)
+{
+    if (chance >= 1)
+    {
+        return 0;
+    }
+    if (chance <= 0)
+    {
+        return std::numeric_limits<std::int64_t>::max();
+    }
+    return std::geometric_distribution<std::int64_t>{chance}(m_eng);
+}
+
 double Random::GetNoise(const double x, const double y)
 {
     return m_noise.GetNoise<double>(x, y);
@@ -43,4 +57,25 @@ double Random::GetNoise(const int x, const int y)
 std::uint64_t Random::Next()
 {
     return m_randomModifier++;
-}
\ No newline at end of file
+}
+
+Random Random::Fork()
+{
+    return Random{Hash(static_cast<std::int64_t>(m_eng()), static_cast<std::int64_t>(m_randomModifier), 0)};
+}
+
+std::uint64_t Random::Hash(const std::int64_t x, const std::int64_t y, const std::uint64_t seed)
+{
+    // splitmix64 finalizer over the packed coordinate
+    std::uint64_t h = seed ^ (static_cast<std::uint64_t>(x) * 0x9E3779B97F4A7C15ULL) ^
+        (static_cast<std::uint64_t>(y) * 0xC2B2AE3D27D4EB4FULL);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+double Random::HashDouble(const std::int64_t x, const std::int64_t y, const std::uint64_t seed)
+{
+    constexpr double INV_2_53 = 1.0 / 9007199254740992.0;
+    return static_cast<double>(Hash(x, y, seed) >> 11) * INV_2_53;
+}
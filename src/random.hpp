@@ -19,9 +19,17 @@ class Random
     int GetInt(int min, int max);
     int GetInt(double min, double max);
     int GetInt(Vector2<int>);
+    // Number of failed trials before the first success, each succeeding with the given chance
+    std::int64_t GetGeometric(double chance);
     double GetNoise(double x, double y);
     double GetNoise(int x, int y);
     std::uint64_t Next();
+    // Independent stream seeded from this one, for passes that should not share the main sequence
+    Random Fork();
+
+    // Stateless hashes of a coordinate, for per-tile variation that does not depend on evaluation order
+    static std::uint64_t Hash(std::int64_t x, std::int64_t y, std::uint64_t seed);
+    static double HashDouble(std::int64_t x, std::int64_t y, std::uint64_t seed);
 };
 
 #endif    // TERRAGEN_RANDOM_HPP
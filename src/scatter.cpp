@@ -0,0 +1,146 @@
+#include "scatter.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Darts thrown per point a chunk still needs before it gives up
+constexpr int ATTEMPTS_PER_POINT = 8;
+// Chunk width in grid cells. Neighbours are looked up two cells away, so chunks of the same parity never interact
+constexpr int CHUNK_CELLS = 8;
+constexpr int NEIGHBOUR_CELLS = 2;
+
+struct Grid
+{
+    Scatter::Layer layer;
+    double cell;
+    int columns;
+    int rows;
+    int chunks;
+    // Point index + 1 per cell, 0 when empty
+    std::vector<std::uint32_t> cells;
+    std::vector<Scatter::Batch> chunkPoints;
+};
+
+Grid MakeGrid(const Scatter::Layer& layer)
+{
+    Grid grid{layer, std::max(layer.spacing / std::sqrt(2.0), 1.0), 0, 0, 0, {}, {}};
+    const int width = std::max(layer.horizontal.y - layer.horizontal.x, 0);
+    const int height = std::max(layer.vertical.y - layer.vertical.x, 0);
+    grid.columns = static_cast<int>(std::ceil(width / grid.cell));
+    grid.rows = static_cast<int>(std::ceil(height / grid.cell));
+    grid.chunks = (grid.columns + CHUNK_CELLS - 1) / CHUNK_CELLS;
+    grid.cells.assign(static_cast<std::size_t>(grid.columns) * grid.rows, 0);
+    grid.chunkPoints.resize(grid.chunks);
+    return grid;
+}
+
+const Vector2<int>& PointAt(const Grid& grid, std::uint32_t id)
+{
+    // Ids pack the chunk and the index within it, so chunks can append without sharing a counter
+    return grid.chunkPoints[id >> 20][id & 0xFFFFF];
+}
+
+void FillChunk(Grid& grid, int chunk, std::uint64_t seed)
+{
+    const Scatter::Layer& layer = grid.layer;
+    const int left = layer.horizontal.x + static_cast<int>(chunk * CHUNK_CELLS * grid.cell);
+    const int right =
+        std::min(layer.horizontal.x + static_cast<int>((chunk + 1) * CHUNK_CELLS * grid.cell), layer.horizontal.y);
+    const int top = layer.vertical.x;
+    const int bottom = layer.vertical.y;
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
+
+    // Targets are rounded on the running total so the chunks of a band add up to the band's expected count
+    const double perColumn = (bottom - top) * layer.density;
+    const auto target = static_cast<int>(
+        std::lround((right - layer.horizontal.x) * perColumn) - std::lround((left - layer.horizontal.x) * perColumn));
+    const double spacingSquared = layer.spacing * layer.spacing;
+
+    Scatter::Batch& points = grid.chunkPoints[chunk];
+    const int attempts = target * ATTEMPTS_PER_POINT;
+    for (int attempt = 0; attempt < attempts && static_cast<int>(points.size()) < target; ++attempt)
+    {
+        const std::uint64_t h = Random::Hash(chunk, attempt, seed);
+        const int x = left + static_cast<int>((h & 0xFFFFFFFF) % static_cast<std::uint64_t>(right - left));
+        const int y = top + static_cast<int>((h >> 32) % static_cast<std::uint64_t>(bottom - top));
+        const int column = static_cast<int>((x - layer.horizontal.x) / grid.cell);
+        const int row = static_cast<int>((y - top) / grid.cell);
+        std::uint32_t& cell = grid.cells[static_cast<std::size_t>(row) * grid.columns + column];
+        if (cell != 0)
+        {
+            continue;
+        }
+
+        bool free = true;
+        for (int r = std::max(row - NEIGHBOUR_CELLS, 0); free && r <= std::min(row + NEIGHBOUR_CELLS, grid.rows - 1);
+             ++r)
+        {
+            for (int c = std::max(column - NEIGHBOUR_CELLS, 0);
+                 c <= std::min(column + NEIGHBOUR_CELLS, grid.columns - 1);
+                 ++c)
+            {
+                const std::uint32_t other = grid.cells[static_cast<std::size_t>(r) * grid.columns + c];
+                if (other == 0)
+                {
+                    continue;
+                }
+                const Vector2<int>& p = PointAt(grid, other - 1);
+                const double dx = p.x - x;
+                const double dy = p.y - y;
+                if (dx * dx + dy * dy < spacingSquared)
+                {
+                    free = false;
+                    break;
+                }
+            }
+        }
+        if (free)
+        {
+            cell = (static_cast<std::uint32_t>(chunk) << 20 | static_cast<std::uint32_t>(points.size())) + 1;
+            points.push_back(Vector2<int>{x, y});
+        }
+    }
+}
+}    // namespace
+
+std::vector<Scatter::Batch> Scatter::Sample(const std::vector<Layer>& layers, std::uint64_t seed)
+{
+    std::vector<Grid> grids;
+    grids.reserve(layers.size());
+    for (const Layer& layer : layers)
+    {
+        grids.push_back(MakeGrid(layer));
+    }
+
+    for (int parity = 0; parity < 2; ++parity)
+    {
+        std::vector<Vector2<int>> tasks;
+        for (std::size_t i = 0; i < grids.size(); ++i)
+        {
+            for (int chunk = parity; chunk < grids[i].chunks; chunk += 2)
+            {
+                tasks.push_back(Vector2<int>{static_cast<int>(i), chunk});
+            }
+        }
+        Parallel::For(tasks.size(), [&](std::size_t task) {
+            const auto [layer, chunk] = tasks[task];
+            FillChunk(grids[layer], chunk, Random::Hash(layer, 0, seed));
+        });
+    }
+
+    std::vector<Batch> batches(grids.size());
+    for (std::size_t i = 0; i < grids.size(); ++i)
+    {
+        for (const Batch& points : grids[i].chunkPoints)
+        {
+            batches[i].insert(batches[i].end(), points.begin(), points.end());
+        }
+    }
+    return batches;
+}
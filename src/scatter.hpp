@@ -0,0 +1,33 @@
+#ifndef TERRAGEN_SCATTER_HPP
+#define TERRAGEN_SCATTER_HPP
+
+#include "vector_2.hpp"
+#include <cstdint>
+#include <vector>
+
+// Blue-noise (Poisson-disk) placement of points inside horizontal bands of the world.
+//
+// Every band is covered by a grid with at most one point per cell and split into column chunks. Even chunks are
+// filled by dart throwing in parallel, then odd chunks, which only have to look across their borders at points
+// that already exist. Work is linear in the band area, and the result does not depend on the number of threads.
+namespace Scatter
+{
+struct Layer
+{
+    // Half-open tile ranges the points are placed in
+    Vector2<int> horizontal;
+    Vector2<int> vertical;
+    // Expected points per tile of the band
+    double density;
+    // No two points of the same layer are closer than this
+    double spacing;
+};
+
+// Points of one layer, in a fixed order
+using Batch = std::vector<Vector2<int>>;
+
+// Returns one batch per layer
+std::vector<Batch> Sample(const std::vector<Layer>& layers, std::uint64_t seed);
+}    // namespace Scatter
+
+#endif    // TERRAGEN_SCATTER_HPP
@@ -0,0 +1,104 @@
+#include "slopes.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace
+{
+constexpr int WORD_BITS = 64;
+constexpr std::size_t ROWS_PER_TASK = 16;
+
+constexpr Tile::Style Shape(std::uint8_t neighbours)
+{
+    using namespace Slopes;
+
+    const auto has = [&](std::uint8_t bits) { return (neighbours & bits) == bits; };
+    const auto open = [&](std::uint8_t bits) { return (neighbours & bits) == 0; };
+    if (open(NORTH | WEST | EAST) && has(SOUTH))
+    {
+        return Tile::Style::HalfBrick;
+    }
+    if (open(NORTH | WEST) && has(EAST | SOUTH | SOUTH_EAST))
+    {
+        return Tile::Style::SlopeTopLeft;
+    }
+    if (open(NORTH | EAST) && has(WEST | SOUTH | SOUTH_WEST))
+    {
+        return Tile::Style::SlopeTopRight;
+    }
+    if (open(SOUTH | WEST) && has(EAST | NORTH | NORTH_EAST))
+    {
+        return Tile::Style::SlopeBottomLeft;
+    }
+    if (open(SOUTH | EAST) && has(WEST | NORTH | NORTH_WEST))
+    {
+        return Tile::Style::SlopeBottomRight;
+    }
+    return Tile::Style::Full;
+}
+
+constexpr std::array<Tile::Style, 256> MakeTable()
+{
+    std::array<Tile::Style, 256> table{};
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+        table[i] = Shape(static_cast<std::uint8_t>(i));
+    }
+    return table;
+}
+
+constexpr std::array<Tile::Style, 256> TABLE = MakeTable();
+
+static_assert(TABLE[0xFF] == Tile::Style::Full);
+static_assert(TABLE[Slopes::SOUTH] == Tile::Style::HalfBrick);
+}    // namespace
+
+Tile::Style Slopes::StyleOf(std::uint8_t neighbours)
+{
+    return TABLE[neighbours];
+}
+
+void Slopes::Classify(const Bitplane& solid, std::vector<Tile::Style>& styles)
+{
+    const int width = solid.GetWidth();
+    Parallel::ForRange(solid.GetHeight(), ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
+        {
+            Tile::Style* row = &styles[static_cast<std::size_t>(width) * y];
+            std::fill(row, row + width, Tile::Style::Full);
+            for (int word = 0; word < solid.GetWords(); ++word)
+            {
+                const std::uint64_t center = solid.Word(word, y, false);
+                if (center == 0)
+                {
+                    continue;
+                }
+                // One plane per neighbour, bit i of each lined up with bit i of center
+                const std::array<std::uint64_t, 8> planes{
+                    solid.Shifted(word, y - 1, -1, true),
+                    solid.Shifted(word, y - 1, 0, true),
+                    solid.Shifted(word, y - 1, 1, true),
+                    solid.Shifted(word, y, -1, true),
+                    solid.Shifted(word, y, 1, true),
+                    solid.Shifted(word, y + 1, -1, true),
+                    solid.Shifted(word, y + 1, 0, true),
+                    solid.Shifted(word, y + 1, 1, true),
+                };
+                // Blocks with all four sides covered stay Full whatever the corners are
+                std::uint64_t edges = center & ~(planes[1] & planes[3] & planes[4] & planes[6]);
+                while (edges != 0)
+                {
+                    const int bit = std::countr_zero(edges);
+                    edges &= edges - 1;
+                    std::uint8_t neighbours = 0;
+                    for (std::size_t i = 0; i < planes.size(); ++i)
+                    {
+                        neighbours |= static_cast<std::uint8_t>(((planes[i] >> bit) & 1U) << i);
+                    }
+                    row[word * WORD_BITS + bit] = TABLE[neighbours];
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,31 @@
+#ifndef TERRAGEN_SLOPES_HPP
+#define TERRAGEN_SLOPES_HPP
+
+#include "bitplane.hpp"
+#include "tile.hpp"
+#include <cstdint>
+#include <vector>
+
+// Chooses the shape (Tile::Style) of every block from the solid blocks around it, to smooth out the world.
+//
+// The eight neighbours of a tile are packed into a byte and mapped through a table: a block open above and on one side
+// but resting on solid ground becomes a slope, and a lone bump on the surface becomes a half brick. Whole words of
+// the solid bitplane are checked at once, so only blocks on an edge are looked at one by one.
+namespace Slopes
+{
+// Neighbour bits of the mask; tiles outside the world count as solid
+constexpr std::uint8_t NORTH_WEST = 1U << 0;
+constexpr std::uint8_t NORTH = 1U << 1;
+constexpr std::uint8_t NORTH_EAST = 1U << 2;
+constexpr std::uint8_t WEST = 1U << 3;
+constexpr std::uint8_t EAST = 1U << 4;
+constexpr std::uint8_t SOUTH_WEST = 1U << 5;
+constexpr std::uint8_t SOUTH = 1U << 6;
+constexpr std::uint8_t SOUTH_EAST = 1U << 7;
+
+[[nodiscard]] Tile::Style StyleOf(std::uint8_t neighbours);
+// Writes the style of every tile; tiles that are not solid are Full
+void Classify(const Bitplane& solid, std::vector<Tile::Style>& styles);
+}    // namespace Slopes
+
+#endif    // TERRAGEN_SLOPES_HPP
@@ -0,0 +1,39 @@
+#ifndef TERRAGEN_SPARSE_SAMPLER_HPP
+#define TERRAGEN_SPARSE_SAMPLER_HPP
+
+#include "random.hpp"
+#include <cstdint>
+
+// Runs independent "chance per tile" trials without drawing a number for every tile: the distance to the next hit
+// is drawn from a geometric distribution and the misses in between are skipped. Work is proportional to the number
+// of hits. The pending gap carries over between calls, so a pass can feed it one column or row at a time.
+class SparseSampler
+{
+    Random& m_random;
+    double m_chance;
+    std::int64_t m_gap;
+
+  public:
+    SparseSampler(Random& random, double chance)
+        : m_random{random}, m_chance{chance}, m_gap{random.GetGeometric(chance)}
+    {
+    }
+
+    // Calls visit(i) for every hit i in [0, count)
+    template <class Visit> void Run(std::int64_t count, Visit visit)
+    {
+        if (count <= 0)
+        {
+            return;
+        }
+        std::int64_t i = m_gap;
+        while (i < count)
+        {
+            visit(i);
+            i += 1 + m_random.GetGeometric(m_chance);
+        }
+        m_gap = i - count;
+    }
+};
+
+#endif    // TERRAGEN_SPARSE_SAMPLER_HPP
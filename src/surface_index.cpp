@@ -0,0 +1,58 @@
+#include "surface_index.hpp"
+#include "tile_traits.hpp"
+#include <algorithm>
+
+SurfaceIndex::SurfaceIndex(int width, int height) : m_width{width}, m_height{height}, m_top(width, height)
+{
+}
+
+int SurfaceIndex::FindFrom(const std::vector<Tile>& tiles, int x, int y, int end) const
+{
+    while (y < end && !TileTraits::HasAny(tiles[x + static_cast<std::size_t>(m_width) * y].m_type, TileTraits::SOLID))
+    {
+        ++y;
+    }
+    return y;
+}
+
+int SurfaceIndex::Top(int x) const
+{
+    return m_top[x];
+}
+
+void SurfaceIndex::Update(const std::vector<Tile>& tiles, int x, int y)
+{
+    if (TileTraits::HasAny(tiles[x + static_cast<std::size_t>(m_width) * y].m_type, TileTraits::SOLID))
+    {
+        m_top[x] = std::min(m_top[x], y);
+    }
+    else if (y == m_top[x])
+    {
+        m_top[x] = FindFrom(tiles, x, y + 1, m_height);
+    }
+}
+
+void SurfaceIndex::Refresh(const std::vector<Tile>& tiles, int left, int top, int right, int bottom)
+{
+    top = std::max(top, 0);
+    bottom = std::min(bottom, m_height);
+    for (int x = std::max(left, 0); x < std::min(right, m_width); ++x)
+    {
+        // Rows above the rectangle did not change and rows between it and the old surface are still open, so a new
+        // block above the old surface can only be inside the rectangle
+        if (m_top[x] < top)
+        {
+            continue;
+        }
+        const int limit = std::min(bottom, m_top[x]);
+        const int found = FindFrom(tiles, x, top, limit);
+        if (found < limit)
+        {
+            m_top[x] = found;
+        }
+        else if (m_top[x] < bottom)
+        {
+            m_top[x] = FindFrom(tiles, x, m_top[x], m_height);
+        }
+    }
+}
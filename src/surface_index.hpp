@@ -0,0 +1,34 @@
+#ifndef TERRAGEN_SURFACE_INDEX_HPP
+#define TERRAGEN_SURFACE_INDEX_HPP
+
+#include "tile.hpp"
+#include <vector>
+
+// Row of the topmost solid tile of every column, kept up to date as tiles change so surface passes can look the
+// surface up instead of searching for it.
+//
+// A single write only moves the surface when it puts a block above it (the surface rises to it) or clears the surface
+// tile itself (the column is searched down to the next block). Bulk writers that bypass the tile setters refresh the
+// rectangle they touched; columns whose surface lies above it are unaffected and skipped.
+class SurfaceIndex
+{
+    int m_width;
+    int m_height;
+    std::vector<int> m_top;
+
+    // First solid row of column x in [y, end), or end
+    [[nodiscard]] int FindFrom(const std::vector<Tile>& tiles, int x, int y, int end) const;
+
+  public:
+    SurfaceIndex(int width, int height);
+
+    // Row of the topmost solid tile, or the world height for a column without any
+    [[nodiscard]] int Top(int x) const;
+    // Call after tile (x, y) changed type
+    void Update(const std::vector<Tile>& tiles, int x, int y);
+    // Call after any tiles in the half-open rectangle changed type. Columns are independent, so disjoint column
+    // ranges may be refreshed in parallel
+    void Refresh(const std::vector<Tile>& tiles, int left, int top, int right, int bottom);
+};
+
+#endif    // TERRAGEN_SURFACE_INDEX_HPP
@@ -54,6 +54,12 @@ const std::unordered_map<Tile::Type, SDL_Color> TILE_TYPE_COLORS{
     {Tile::Type::Tungsten, {190, 190, 190, 255}},
     {Tile::Type::Gold, {255, 215, 20, 255}},
     {Tile::Type::Platinum, {255, 215, 20, 255}},
+    {Tile::Type::Amethyst, {165, 0, 236, 255}},
+    {Tile::Type::Topaz, {255, 198, 0, 255}},
+    {Tile::Type::Sapphire, {0, 106, 255, 255}},
+    {Tile::Type::Emerald, {0, 192, 72, 255}},
+    {Tile::Type::Ruby, {224, 17, 95, 255}},
+    {Tile::Type::Diamond, {185, 242, 255, 255}},
     {Tile::Type::Web, {250, 250, 250, 255}},
 };
 
@@ -11,7 +11,7 @@ extern "C"
 
 struct Tile
 {
-    enum class Type
+    enum class Type : std::uint8_t
     {
         Air,
         Dirt,
@@ -31,9 +31,15 @@ struct Tile
         Tungsten,
         Gold,
         Platinum,
+        Amethyst,
+        Topaz,
+        Sapphire,
+        Emerald,
+        Ruby,
+        Diamond,
         Web,
     };
-    enum class Style
+    enum class Style : std::uint8_t
     {
         Full,
         HalfBrick,
@@ -42,14 +48,14 @@ struct Tile
         SlopeBottomRight,
         SlopeBottomLeft,
     };
-    enum class Liquid
+    enum class Liquid : std::uint8_t
     {
         None,
         Water,
         Lava,
         Honey,
     };
-    enum class Wall
+    enum class Wall : std::uint8_t
     {
         Air,
         Dirt,
@@ -0,0 +1,120 @@
+#include "tile_counts.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+
+namespace
+{
+constexpr std::size_t ROWS_PER_TASK = 16;
+constexpr std::size_t BLOCK_COLUMNS = 64;
+}    // namespace
+
+TileCounts::TileCounts(int width, int height) : m_width{width}, m_height{height}
+{
+}
+
+void TileCounts::Rebuild(const std::vector<Tile>& tiles, Table& table) const
+{
+    const std::size_t stride = static_cast<std::size_t>(m_width) + 1;
+
+    // Column x is out of date from row from[x] down, since a dirty tile spoils every entry right of it too
+    std::vector<int> from(m_width);
+    int top = m_height;
+    for (int x = 0; x < m_width; ++x)
+    {
+        top = std::min(top, table.dirty[x]);
+        from[x] = top;
+    }
+
+    // Sums across the out-of-date part of each row, carrying on from the up-to-date entry left of it. from never
+    // grows, so a row is out of date from the first column whose from is at or above it
+    Parallel::ForRange(m_height - top, ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        for (int y = top + static_cast<int>(begin); y < top + static_cast<int>(end); ++y)
+        {
+            const int left =
+                static_cast<int>(std::partition_point(from.begin(), from.end(), [y](int f) { return f > y; }) -
+                                 from.begin());
+            const std::uint32_t* above = &table.sums[y * stride];
+            std::uint32_t* row = &table.sums[(y + 1) * stride];
+            std::uint32_t run = row[left] - above[left];
+            const Tile* line = &tiles[static_cast<std::size_t>(m_width) * y];
+            for (int x = left; x < m_width; ++x)
+            {
+                run += TileTraits::InSet(line[x].m_type, table.types) ? 1 : 0;
+                row[x + 1] = run;
+            }
+        }
+    });
+
+    // Sums down the out-of-date part of each column, a block of columns at a time so rows are read in order
+    Parallel::ForRange(m_width, BLOCK_COLUMNS, [&](std::size_t begin, std::size_t end) {
+        for (int y = top; y < m_height; ++y)
+        {
+            const std::uint32_t* above = &table.sums[y * stride + 1];
+            std::uint32_t* row = &table.sums[(y + 1) * stride + 1];
+            for (std::size_t x = begin; x < end; ++x)
+            {
+                if (y >= from[x])
+                {
+                    row[x] += above[x];
+                }
+            }
+        }
+    });
+
+    std::fill(table.dirty.begin(), table.dirty.end(), m_height);
+    table.stale.store(false, std::memory_order_relaxed);
+}
+
+std::uint32_t TileCounts::Count(
+    const std::vector<Tile>& tiles, TileTraits::TypeSet types, Vector2<int> horizontal, Vector2<int> vertical)
+{
+    auto it = std::find_if(m_tables.begin(), m_tables.end(), [types](const auto& table) {
+        return table->types == types;
+    });
+    if (it == m_tables.end())
+    {
+        auto table = std::make_unique<Table>();
+        table->types = types;
+        table->sums.resize((static_cast<std::size_t>(m_width) + 1) * (static_cast<std::size_t>(m_height) + 1));
+        table->dirty.assign(m_width, 0);
+        m_tables.push_back(std::move(table));
+        it = m_tables.end() - 1;
+    }
+    Table& table = **it;
+    if (table.stale.load(std::memory_order_relaxed))
+    {
+        Rebuild(tiles, table);
+    }
+
+    const int left = std::clamp(horizontal.x, 0, m_width);
+    const int right = std::clamp(horizontal.y, left, m_width);
+    const int top = std::clamp(vertical.x, 0, m_height);
+    const int bottom = std::clamp(vertical.y, top, m_height);
+    const auto at = [&](int x, int y) { return table.sums[x + (static_cast<std::size_t>(m_width) + 1) * y]; };
+    return at(right, bottom) - at(left, bottom) - at(right, top) + at(left, top);
+}
+
+void TileCounts::Invalidate(int x, int y)
+{
+    for (const auto& table : m_tables)
+    {
+        if (y < table->dirty[x])
+        {
+            table->dirty[x] = y;
+            table->stale.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TileCounts::Invalidate(int left, int top, int right, int bottom)
+{
+    top = std::max(top, 0);
+    if (top >= std::min(bottom, m_height))
+    {
+        return;
+    }
+    for (int x = std::max(left, 0); x < std::min(right, m_width); ++x)
+    {
+        Invalidate(x, top);
+    }
+}
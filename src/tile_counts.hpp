@@ -0,0 +1,51 @@
+#ifndef TERRAGEN_TILE_COUNTS_HPP
+#define TERRAGEN_TILE_COUNTS_HPP
+
+#include "tile.hpp"
+#include "tile_traits.hpp"
+#include "vector_2.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Number of tiles with a type in a set inside any rectangle in constant time, from summed-area tables built the
+// first time a set is asked about.
+//
+// Every entry of a table is the count over the rectangle from the origin to it, so a rectangle takes four lookups.
+// Tables are built with parallel prefix sums: rows are summed across in parallel, then blocks of columns sum down.
+// Writes mark their column dirty from their row down. An entry covers everything above and left of it, so the next
+// query only rebuilds the entries below and right of a dirty tile, and clean tables are never touched.
+class TileCounts
+{
+    struct Table
+    {
+        TileTraits::TypeSet types;
+        // (width + 1) x (height + 1) with a zero first row and column
+        std::vector<std::uint32_t> sums;
+        // First row of each column written since the last rebuild, or the height
+        std::vector<int> dirty;
+        // Set with the first dirty row so queries on clean tables do not look at the columns
+        std::atomic<bool> stale{true};
+    };
+
+    int m_width;
+    int m_height;
+    std::vector<std::unique_ptr<Table>> m_tables;
+
+    void Rebuild(const std::vector<Tile>& tiles, Table& table) const;
+
+  public:
+    TileCounts(int width, int height);
+
+    // Tiles with a type in the set in the half-open rectangle, clipped to the world
+    std::uint32_t Count(
+        const std::vector<Tile>& tiles, TileTraits::TypeSet types, Vector2<int> horizontal, Vector2<int> vertical);
+    // Call after tile (x, y) changed type. Columns are independent, so disjoint columns may be invalidated in
+    // parallel, but not while a query runs
+    void Invalidate(int x, int y);
+    // Call after any tiles in the half-open rectangle changed type
+    void Invalidate(int left, int top, int right, int bottom);
+};
+
+#endif    // TERRAGEN_TILE_COUNTS_HPP
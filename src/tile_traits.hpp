@@ -0,0 +1,121 @@
+#ifndef TERRAGEN_TILE_TRAITS_HPP
+#define TERRAGEN_TILE_TRAITS_HPP
+
+#include "tile.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+// Per-type properties of tiles, looked up from a table instead of IsTile chains and switches.
+// New tile types (and biome conversions) only need to be described here.
+namespace TileTraits
+{
+using Mask = std::uint16_t;
+
+constexpr Mask NONE = 0;
+// Blocks movement and supports things placed on top of it
+constexpr Mask SOLID = 1U << 0;
+// Falls down when there is nothing below it
+constexpr Mask GRAVITY = 1U << 1;
+// Metal ores placed by GenerateMetals
+constexpr Mask ORE = 1U << 2;
+// Loose earth blocks (converted to snow / mud by biomes)
+constexpr Mask SOIL = 1U << 3;
+// Blocks that ore veins may overwrite
+constexpr Mask ORE_REPLACEABLE = 1U << 4;
+// Blocks that clay patches may overwrite
+constexpr Mask CLAY_REPLACEABLE = 1U << 5;
+// Blocks that grass can grow on
+constexpr Mask GRASS_HOST = 1U << 6;
+// Gem blocks placed by GenerateGems
+constexpr Mask GEM = 1U << 7;
+
+constexpr std::size_t TYPE_COUNT = static_cast<std::size_t>(Tile::Type::Web) + 1;
+
+constexpr std::array<Mask, TYPE_COUNT> TABLE{
+    /* Air      */ NONE,
+    /* Dirt     */ SOLID | SOIL | ORE_REPLACEABLE | CLAY_REPLACEABLE | GRASS_HOST,
+    /* Grass    */ SOLID | SOIL,
+    /* Stone    */ SOLID | ORE_REPLACEABLE | CLAY_REPLACEABLE,
+    /* Sand     */ SOLID | GRAVITY | SOIL | ORE_REPLACEABLE,
+    /* Clay     */ SOLID | SOIL | ORE_REPLACEABLE,
+    /* Mud      */ SOLID | SOIL | ORE_REPLACEABLE,
+    /* Silt     */ SOLID | GRAVITY | ORE_REPLACEABLE,
+    /* Slush    */ SOLID | GRAVITY | ORE_REPLACEABLE,
+    /* Ash      */ SOLID | ORE_REPLACEABLE,
+    /* Copper   */ SOLID | ORE,
+    /* Tin      */ SOLID | ORE,
+    /* Iron     */ SOLID | ORE,
+    /* Lead     */ SOLID | ORE,
+    /* Silver   */ SOLID | ORE,
+    /* Tungsten */ SOLID | ORE,
+    /* Gold     */ SOLID | ORE,
+    /* Platinum */ SOLID | ORE,
+    /* Amethyst */ SOLID | GEM,
+    /* Topaz    */ SOLID | GEM,
+    /* Sapphire */ SOLID | GEM,
+    /* Emerald  */ SOLID | GEM,
+    /* Ruby     */ SOLID | GEM,
+    /* Diamond  */ SOLID | GEM,
+    /* Web      */ NONE,
+};
+
+[[nodiscard]] constexpr Mask Of(const Tile::Type type)
+{
+    return TABLE[static_cast<std::size_t>(type)];
+}
+
+// True if the type has any of the traits in mask
+[[nodiscard]] constexpr bool HasAny(const Tile::Type type, const Mask mask)
+{
+    return (Of(type) & mask) != 0;
+}
+
+// True if the type has every trait in mask
+[[nodiscard]] constexpr bool HasAll(const Tile::Type type, const Mask mask)
+{
+    return (Of(type) & mask) == mask;
+}
+
+// Set of tile types as one bit per type, for "is one of these" tests
+using TypeSet = std::uint32_t;
+static_assert(TYPE_COUNT <= sizeof(TypeSet) * 8, "TypeSet is too small for Tile::Type");
+
+constexpr TypeSet ALL_TYPES = static_cast<TypeSet>((std::uint64_t{1} << TYPE_COUNT) - 1);
+
+[[nodiscard]] constexpr TypeSet MakeSet(const std::initializer_list<Tile::Type> types)
+{
+    TypeSet set = 0;
+    for (const Tile::Type type : types)
+    {
+        set |= TypeSet{1} << static_cast<unsigned>(type);
+    }
+    return set;
+}
+
+// Set of all types with any of the traits in mask
+[[nodiscard]] constexpr TypeSet SetOf(const Mask mask)
+{
+    TypeSet set = 0;
+    for (std::size_t i = 0; i < TYPE_COUNT; ++i)
+    {
+        if ((TABLE[i] & mask) != 0)
+        {
+            set |= TypeSet{1} << i;
+        }
+    }
+    return set;
+}
+
+[[nodiscard]] constexpr bool InSet(const Tile::Type type, const TypeSet set)
+{
+    return ((set >> static_cast<unsigned>(type)) & 1U) != 0;
+}
+
+static_assert(!HasAny(Tile::Type::Air, SOLID));
+static_assert(HasAll(Tile::Type::Sand, SOLID | GRAVITY));
+static_assert(SetOf(CLAY_REPLACEABLE) == MakeSet({Tile::Type::Dirt, Tile::Type::Stone}));
+}    // namespace TileTraits
+
+#endif    // TERRAGEN_TILE_TRAITS_HPP
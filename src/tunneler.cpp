@@ -0,0 +1,168 @@
+#include "tunneler.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+constexpr int BAND_ROWS = 32;
+// Fraction of the radius range the brush can drift by in one step
+constexpr double RADIUS_DRIFT = 0.25;
+
+// Rows whose tile centres the capsule reaches, half-open and unclipped
+Vector2<int> Rows(const Tunneler::Capsule& capsule)
+{
+    const double top = std::min(capsule.from.y, capsule.to.y) - capsule.radius;
+    const double bottom = std::max(capsule.from.y, capsule.to.y) + capsule.radius;
+    return Vector2<int>{
+        static_cast<int>(std::ceil(top - 0.5)),
+        static_cast<int>(std::floor(bottom - 0.5)) + 1,
+    };
+}
+
+// Interval of the horizontal line at row centre yc that is inside the capsule, empty when x > y. The capsule is
+// convex, so this is the hull of what the two end discs and the band between them cover
+Vector2<double> Span(const Tunneler::Capsule& capsule, double yc)
+{
+    double left = std::numeric_limits<double>::infinity();
+    double right = -std::numeric_limits<double>::infinity();
+    const auto add = [&](double x) {
+        left = std::min(left, x);
+        right = std::max(right, x);
+    };
+
+    for (const Vector2<double>& centre : {capsule.from, capsule.to})
+    {
+        const double dy = yc - centre.y;
+        const double squared = capsule.radius * capsule.radius - dy * dy;
+        if (squared >= 0)
+        {
+            add(centre.x - std::sqrt(squared));
+            add(centre.x + std::sqrt(squared));
+        }
+    }
+
+    const double dx = capsule.to.x - capsule.from.x;
+    const double dy = capsule.to.y - capsule.from.y;
+    const double length = std::hypot(dx, dy);
+    if (length > 0)
+    {
+        // The segment pushed out by the radius on both sides
+        const Vector2<double> normal{-dy / length * capsule.radius, dx / length * capsule.radius};
+        const std::array<Vector2<double>, 4> corners{
+            Vector2<double>{capsule.from.x + normal.x, capsule.from.y + normal.y},
+            Vector2<double>{capsule.to.x + normal.x, capsule.to.y + normal.y},
+            Vector2<double>{capsule.to.x - normal.x, capsule.to.y - normal.y},
+            Vector2<double>{capsule.from.x - normal.x, capsule.from.y - normal.y},
+        };
+        for (std::size_t i = 0; i < corners.size(); ++i)
+        {
+            const Vector2<double>& a = corners[i];
+            const Vector2<double>& b = corners[(i + 1) % corners.size()];
+            if ((a.y <= yc) != (b.y <= yc))
+            {
+                add(a.x + (yc - a.y) / (b.y - a.y) * (b.x - a.x));
+            }
+        }
+    }
+    return Vector2<double>{left, right};
+}
+}    // namespace
+
+std::vector<Tunneler::Capsule> Tunneler::Walk(const Worm& worm, int width, int height)
+{
+    Random random{worm.seed};
+    const double drift = (worm.radius.y - worm.radius.x) * RADIUS_DRIFT;
+
+    std::vector<Capsule> capsules;
+    capsules.reserve(worm.steps);
+    Vector2<double> position = worm.start;
+    double heading = worm.heading;
+    double radius = random.GetDouble(worm.radius);
+    for (int step = 0; step < worm.steps; ++step)
+    {
+        heading += random.GetDouble(-worm.turn, worm.turn);
+        heading += (worm.pullHeading - heading) * worm.pull;
+        radius = std::clamp(radius + random.GetDouble(-drift, drift), worm.radius.x, worm.radius.y);
+
+        const Vector2<double> next{
+            position.x + std::cos(heading) * worm.stepLength,
+            position.y + std::sin(heading) * worm.stepLength,
+        };
+        capsules.push_back(Capsule{position, next, radius});
+        position = next;
+        if (position.x < 0 || position.x >= width || position.y < 0 || position.y >= height)
+        {
+            break;
+        }
+    }
+    return capsules;
+}
+
+Vector2<int> Tunneler::Dig(
+    std::vector<Tile>& tiles,
+    int width,
+    int height,
+    const std::vector<Worm>& worms,
+    TileTraits::TypeSet carve,
+    Tile::Type fill)
+{
+    std::vector<std::vector<Capsule>> walks(worms.size());
+    Parallel::For(worms.size(), [&](std::size_t i) { walks[i] = Walk(worms[i], width, height); });
+
+    // Every band of rows lists the capsules that reach it, so bands can be carved in parallel. Carving only ever
+    // writes fill, so the order capsules are carved in does not matter
+    const int bands = (height + BAND_ROWS - 1) / BAND_ROWS;
+    std::vector<std::vector<const Capsule*>> binned(bands);
+    Vector2<int> touched{height, 0};
+    for (const std::vector<Capsule>& walk : walks)
+    {
+        for (const Capsule& capsule : walk)
+        {
+            const Vector2<int> rows = Rows(capsule);
+            const int top = std::max(rows.x, 0);
+            const int bottom = std::min(rows.y, height);
+            if (top >= bottom)
+            {
+                continue;
+            }
+            touched = Vector2<int>{std::min(touched.x, top), std::max(touched.y, bottom)};
+            for (int band = top / BAND_ROWS; band <= (bottom - 1) / BAND_ROWS; ++band)
+            {
+                binned[band].push_back(&capsule);
+            }
+        }
+    }
+
+    Parallel::For(bands, [&](std::size_t band) {
+        const int first = static_cast<int>(band) * BAND_ROWS;
+        const int last = std::min(first + BAND_ROWS, height);
+        for (const Capsule* capsule : binned[band])
+        {
+            const Vector2<int> rows = Rows(*capsule);
+            for (int y = std::max(rows.x, first); y < std::min(rows.y, last); ++y)
+            {
+                // Tiles whose centres are inside the span
+                const Vector2<double> span = Span(*capsule, y + 0.5);
+                if (span.x > span.y)
+                {
+                    continue;
+                }
+                const int left = std::max(static_cast<int>(std::ceil(span.x - 0.5)), 0);
+                const int right = std::min(static_cast<int>(std::floor(span.y - 0.5)) + 1, width);
+                Tile* row = &tiles[static_cast<std::size_t>(width) * y];
+                for (int x = left; x < right; ++x)
+                {
+                    if (TileTraits::InSet(row[x].m_type, carve))
+                    {
+                        row[x].m_type = fill;
+                    }
+                }
+            }
+        }
+    });
+    return touched.x < touched.y ? touched : Vector2<int>{0, 0};
+}
@@ -0,0 +1,56 @@
+#ifndef TERRAGEN_TUNNELER_HPP
+#define TERRAGEN_TUNNELER_HPP
+
+#include "tile.hpp"
+#include "tile_traits.hpp"
+#include "vector_2.hpp"
+#include <cstdint>
+#include <vector>
+
+// Random-walk tunnels (entrance caves, chasms, marble walks) carved by a round brush dragged along each walk.
+//
+// Every step of a walk is a capsule: the segment between two positions swept by the brush radius. Capsules are
+// rasterized as spans: a capsule cut by a row is one interval, found from the two end discs and the band between
+// them, so every carved tile is written once per capsule with no per-tile distance test. Tunnels walk in parallel,
+// each from its own random stream, then all of them are carved at once in bands of rows.
+namespace Tunneler
+{
+struct Worm
+{
+    Vector2<double> start;
+    // Radians, 0 is right and pi / 2 is straight down
+    double heading;
+    // Heading the walk is pulled back to, and how strongly (0 to 1 per step)
+    double pullHeading;
+    double pull;
+    // Most the heading turns in one step either way
+    double turn;
+    int steps;
+    double stepLength;
+    // The brush radius drifts between these as the walk goes
+    Vector2<double> radius;
+    std::uint64_t seed;
+};
+
+struct Capsule
+{
+    Vector2<double> from;
+    Vector2<double> to;
+    double radius;
+};
+
+// Capsules along the walk, which ends early if it leaves the world
+std::vector<Capsule> Walk(const Worm& worm, int width, int height);
+
+// Walks every worm and turns the tiles inside their tunnels whose type is in carve into fill. Returns the half-open
+// rows that were touched, empty when nothing was
+Vector2<int> Dig(
+    std::vector<Tile>& tiles,
+    int width,
+    int height,
+    const std::vector<Worm>& worms,
+    TileTraits::TypeSet carve,
+    Tile::Type fill);
+}    // namespace Tunneler
+
+#endif    // TERRAGEN_TUNNELER_HPP
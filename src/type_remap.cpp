@@ -0,0 +1,63 @@
+#include "type_remap.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+constexpr std::size_t ROWS_PER_TASK = 16;
+constexpr int WORD_BITS = 64;
+}    // namespace
+
+void TypeRemap::Apply(
+    std::vector<Tile>& tiles, int width, const Table& table, Vector2<int> horizontal, Vector2<int> vertical)
+{
+    const int height = static_cast<int>(tiles.size() / width);
+    const int left = std::max(horizontal.x, 0);
+    const int right = std::min(horizontal.y, width);
+    const int top = std::max(vertical.x, 0);
+    const int bottom = std::min(vertical.y, height);
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
+
+    Parallel::ForRange(bottom - top, ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        for (int y = top + static_cast<int>(begin); y < top + static_cast<int>(end); ++y)
+        {
+            Tile* row = &tiles[static_cast<std::size_t>(width) * y];
+            for (int x = left; x < right; ++x)
+            {
+                row[x].m_type = table[static_cast<std::uint8_t>(row[x].m_type)];
+            }
+        }
+    });
+}
+
+void TypeRemap::Apply(std::vector<Tile>& tiles, const Table& table, const Bitplane& mask, Vector2<int> rows)
+{
+    const int top = std::max(rows.x, 0);
+    const int bottom = std::min(rows.y, mask.GetHeight());
+    if (top >= bottom)
+    {
+        return;
+    }
+
+    Parallel::ForRange(bottom - top, ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        for (int y = top + static_cast<int>(begin); y < top + static_cast<int>(end); ++y)
+        {
+            Tile* row = &tiles[static_cast<std::size_t>(mask.GetWidth()) * y];
+            const std::uint64_t* bits = mask.Row(y);
+            for (int word = 0; word < mask.GetWords(); ++word)
+            {
+                std::uint64_t set = bits[word];
+                while (set != 0)
+                {
+                    Tile& tile = row[word * WORD_BITS + std::countr_zero(set)];
+                    set &= set - 1;
+                    tile.m_type = table[static_cast<std::uint8_t>(tile.m_type)];
+                }
+            }
+        }
+    });
+}
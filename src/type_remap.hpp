@@ -0,0 +1,66 @@
+#ifndef TERRAGEN_TYPE_REMAP_HPP
+#define TERRAGEN_TYPE_REMAP_HPP
+
+#include "bitplane.hpp"
+#include "tile.hpp"
+#include "tile_traits.hpp"
+#include "vector_2.hpp"
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+// Rewrites tile types through a translation table, for biome conversions (stone to ice, soil to mud and so on).
+//
+// Every tile in the region is looked up in the table and written back, with no branches on the type, so a whole
+// conversion is one pass over memory. Rows run in parallel. Tiles are stored whole rather than as type planes, so
+// there is nothing for byte shuffles to work on; the table lookup is the entire kernel.
+namespace TypeRemap
+{
+// New type of each type, indexed by the type's value
+using Table = std::array<Tile::Type, 256>;
+
+// Table that leaves every type as it is
+[[nodiscard]] constexpr Table Identity()
+{
+    Table table{};
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+        table[i] = static_cast<Tile::Type>(i);
+    }
+    return table;
+}
+
+// Table that turns each first type into the second and leaves the rest alone
+[[nodiscard]] constexpr Table Of(const std::initializer_list<std::pair<Tile::Type, Tile::Type>> changes)
+{
+    Table table = Identity();
+    for (const auto& [from, to] : changes)
+    {
+        table[static_cast<std::size_t>(from)] = to;
+    }
+    return table;
+}
+
+// Table that turns every type in the set into one type
+[[nodiscard]] constexpr Table Into(const TileTraits::TypeSet from, const Tile::Type to)
+{
+    Table table = Identity();
+    for (std::size_t i = 0; i < TileTraits::TYPE_COUNT; ++i)
+    {
+        if (TileTraits::InSet(static_cast<Tile::Type>(i), from))
+        {
+            table[i] = to;
+        }
+    }
+    return table;
+}
+
+// Remaps every tile in the half-open region
+void Apply(std::vector<Tile>& tiles, int width, const Table& table, Vector2<int> horizontal, Vector2<int> vertical);
+// Remaps the tiles whose bit is set in the mask, over the half-open rows
+void Apply(std::vector<Tile>& tiles, const Table& table, const Bitplane& mask, Vector2<int> rows);
+}    // namespace TypeRemap
+
+#endif    // TERRAGEN_TYPE_REMAP_HPP
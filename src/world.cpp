@@ -1,7 +1,7 @@
 #include "world.hpp"
 
-World::World(std::vector<Tile>&& tiles, std::size_t width, std::size_t height)
-    : tiles{std::move(tiles)}, width{width}, height{height}
+World::World(std::vector<Tile>&& tiles, std::vector<Tile::Style>&& styles, std::size_t width, std::size_t height)
+    : tiles{std::move(tiles)}, styles{std::move(styles)}, width{width}, height{height}
 {
     switch (width)
     {
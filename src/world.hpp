@@ -10,6 +10,8 @@
 struct World
 {
     std::vector<Tile> tiles;
+    // Shape of every tile, in the same layout as tiles
+    std::vector<Tile::Style> styles;
     std::size_t width;
     std::size_t height;
     WorldSize size;
@@ -25,7 +27,8 @@ struct World
     static constexpr int WIDTH_LARGE = 8400;
     static constexpr int HEIGHT_LARGE = 2400;
 
-    explicit World(std::vector<Tile>&& tiles, std::size_t width, std::size_t height);
+    explicit World(
+        std::vector<Tile>&& tiles, std::vector<Tile::Style>&& styles, std::size_t width, std::size_t height);
 };
 
 #endif    // TERRAGEN_WORLD_HPP
@@ -41,15 +41,21 @@ World Generate(const WorldSize size)
     auto rockHeights =
         world.RandomTerrain(cavernLayer + ROCK_OFFSET.x, cavernLayer + ROCK_OFFSET.y, ROCK_AMPLITUDE, ROCK_TIMER);
 
+    // Column-local passes run strip by strip between BeginStrips and EndStrips; everything else is a barrier
+    world.BeginStrips();
     world.GenerateDepthLevels(surfaceLayer, cavernLayer, underworldLayer);
     world.GenerateLayers(surfaceTerrain, rockHeights, underworldLayer);
+    world.EndStrips();
     /// Add Tunnels with walls
     world.GenerateSurfaceTunnels(surfaceTerrain);
     /// Add Sand
     world.GenerateSandDesert(surfaceTerrain);
+    world.BeginStrips();
     world.GenerateSandPiles(surfaceLayer, rockHeights);
+    world.EndStrips();
     /// Add Anthills (Mountains with Caves)
     auto anthillCavePos = world.GenerateAnthills(surfaceTerrain);
+    world.BeginStrips();
     /// Mix Stone into Dirt
     world.GenerateSurfaceStone(surfaceTerrain, dirtHeights);
     world.GenerateUndergroundStone(dirtHeights, rockHeights);
@@ -62,18 +68,26 @@ World Generate(const WorldSize size)
      * Rock Layer Caves (Large expansive caves, some water some lava)
      * Surface Caves (Caves from the surface -- entrance caves -- large, winding)
      */
-    world.GenerateCaves(dirtHeights);
-    world.GenerateEntranceCaves(surfaceTerrain);
-    world.GenerateLargeCaves(rockHeights);
+    world.GenerateCaves(dirtHeights, underworldLayer);
+    world.EndStrips();
+    world.GenerateEntranceCaves();
+    world.BeginStrips();
+    world.GenerateLargeCaves(rockHeights, underworldLayer);
+    world.EndStrips();
+    world.SmoothCaves(surfaceLayer, underworldLayer);
 
+    world.BeginStrips();
     /// Add Clay
     world.GenerateClay(surfaceTerrain, dirtHeights, rockHeights);
+    world.EndStrips();
     /// Add Grass
     world.GenerateGrass(surfaceTerrain, surfaceLayer);
+    world.BeginStrips();
     /// Add Mud (Long, veiny stretches of mud. Thin and wiggly)
     world.GenerateMud((surfaceLayer + cavernLayer) / 2, underworldLayer);
     /// Add Silt (Scattered Patches in cavern layer)
     world.GenerateSilt(cavernLayer, underworldLayer);
+    world.EndStrips();
 
     /* BIOMES PART 1
      * Ice (Two diagonal lines going to almost lava level. Convert stone to ice and dirt/clay/sand/mud to snow and silt
@@ -106,12 +120,12 @@ World Generate(const WorldSize size)
 
     /// Anthill Caves (Mountain Caves)
     world.GenerateAnthillCaves(anthillCavePos);
-    /// Gravitating Sand Fix
-    world.FixGravitatingSand(surfaceTerrain);
-    /// Dirt Walls Fix (Remove dirt walls with no tiles above them)
-    world.FixDirtWalls(surfaceTerrain);
-    /// Water on Sand Fix
-    world.FixWaterOnSand(surfaceTerrain);
+    world.BeginStrips();
+    /// Let sand, silt and slush left hanging over caves fall
+    world.SettleGravity();
+    /// Gravitating Sand, Dirt Walls (Remove dirt walls with no tiles above them) and Water on Sand Fixes
+    world.FixSurface();
+    world.EndStrips();
 
     /* BIOMES PART 3
      * Pyramids (Chance)
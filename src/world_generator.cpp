@@ -1,13 +1,25 @@
 #include "world_generator.hpp"
+#include "automaton.hpp"
+#include "bitplane.hpp"
+#include "gravity.hpp"
+#include "liquids.hpp"
+#include "parallel.hpp"
+#include "scatter.hpp"
+#include "slopes.hpp"
+#include "sparse_sampler.hpp"
 #include "vector_2.hpp"
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <numbers>
 
 #pragma region Class Functions
 // Constructor
-WorldGenerator::WorldGenerator(WorldSize size, std::uint64_t seed) : m_random{seed}, m_size{size}
+WorldGenerator::WorldGenerator(WorldSize size, std::uint64_t seed)
+    : m_random{seed}, m_size{size}, m_blobStamper{seed}, m_placement{0}, m_surface{0, 0}, m_counts{0, 0}, m_biomes{0, 0}
 {
     switch (size)
     {
@@ -29,12 +41,89 @@ WorldGenerator::WorldGenerator(WorldSize size, std::uint64_t seed) : m_random{se
         break;    // 20,160,000 tiles
     }
     m_tiles.resize(m_width * m_height, Tile());
+    m_styles.resize(m_width * m_height, Tile::Style::Full);
+    m_placement = PlacementIndex{static_cast<int>(m_width)};
+    m_surface = SurfaceIndex{static_cast<int>(m_width), static_cast<int>(m_height)};
+    m_counts = TileCounts{static_cast<int>(m_width), static_cast<int>(m_height)};
+    m_biomes = BiomeMap{static_cast<int>(m_width), static_cast<int>(m_height)};
 }
 
 std::size_t WorldGenerator::GetHeight() const
 {
     return m_height;
 }
+
+void WorldGenerator::SetBlobMode(BlobStamper::Mode mode)
+{
+    m_blobStamper.SetMode(mode);
+}
+
+const std::vector<WorldGenerator::RegionStats>& WorldGenerator::GetRegionStats() const
+{
+    return m_regionStats;
+}
+
+void WorldGenerator::SetStripMining(bool enabled, int stripWidth)
+{
+    m_stripMining = enabled;
+    m_stripWidth = stripWidth;
+}
+
+void WorldGenerator::SetErosion(bool enabled)
+{
+    m_erosion = enabled;
+}
+
+void WorldGenerator::BeginStrips()
+{
+    m_queueing = m_stripMining;
+}
+
+void WorldGenerator::EndStrips()
+{
+    m_queueing = false;
+    const std::vector<std::function<void(Vector2<int>)>> passes = std::move(m_stripPasses);
+    m_stripPasses.clear();
+    if (passes.empty())
+    {
+        return;
+    }
+    Parallel::ForRange(m_width, StripWidth(), [&](std::size_t begin, std::size_t end) {
+        const Vector2<int> columns{static_cast<int>(begin), static_cast<int>(end)};
+        for (const auto& pass : passes)
+        {
+            pass(columns);
+        }
+    });
+}
+
+// Runs a column-local pass over the half-open column range it is given, or queues it for the current strip run
+void WorldGenerator::RunColumns(std::function<void(Vector2<int>)> pass)
+{
+    if (m_queueing)
+    {
+        m_stripPasses.push_back(std::move(pass));
+        return;
+    }
+    pass(Vector2<int>{0, static_cast<int>(m_width)});
+}
+
+// Widest multiple of STRIP_STEP columns whose tiles fill about half the L2 cache, leaving the rest for noise tables and
+// the stack, but narrow enough that every thread gets several strips
+int WorldGenerator::StripWidth() const
+{
+    constexpr std::size_t STRIP_STEP = 8;
+    constexpr std::size_t STRIPS_PER_THREAD = 4;
+
+    if (m_stripWidth > 0)
+    {
+        return m_stripWidth;
+    }
+    const std::size_t columnBytes = m_height * sizeof(Tile);
+    std::size_t width = Parallel::CacheSize() / 2 / columnBytes;
+    width = std::min(width, m_width / (Parallel::ThreadCount() * STRIPS_PER_THREAD));
+    return static_cast<int>(std::max(width / STRIP_STEP * STRIP_STEP, STRIP_STEP));
+}
 #pragma endregion
 
 // Tile Functions, Terrain and Random Height Functions
@@ -43,6 +132,8 @@ std::size_t WorldGenerator::GetHeight() const
 void WorldGenerator::SetTile(int x, int y, Tile::Type type)
 {
     m_tiles[x + m_width * y].m_type = type;
+    m_surface.Update(m_tiles, x, y);
+    m_counts.Invalidate(x, y);
 }
 void WorldGenerator::SetWall(int x, int y, Tile::Wall wall)
 {
@@ -50,7 +141,7 @@ void WorldGenerator::SetWall(int x, int y, Tile::Wall wall)
 }
 void WorldGenerator::SetLiquid(int x, int y, Tile::Liquid liquid)
 {
-    m_tiles[x + m_width * y].m_liquid = liquid;
+    m_tiles[x + m_width * y].SetLiquid(liquid);
 }
 void WorldGenerator::SetDepth(int x, int y, Tile::Depth depth)
 {
@@ -68,35 +159,192 @@ bool WorldGenerator::IsLiquid(int x, int y, Tile::Liquid liquid)
 {
     return m_tiles[x + m_width * y].m_liquid == liquid;
 }
+bool WorldGenerator::HasTrait(int x, int y, TileTraits::Mask traits)
+{
+    return TileTraits::HasAny(m_tiles[x + m_width * y].m_type, traits);
+}
+int WorldGenerator::GetSurface(int x) const
+{
+    return m_surface.Top(x);
+}
+
+static TileTraits::TypeSet BlobReplaceSet(bool replaceAir, bool overrideBlocks)
+{
+    constexpr TileTraits::TypeSet SOLID_TYPES = TileTraits::SetOf(TileTraits::SOLID);
+
+    TileTraits::TypeSet replace = 0;
+    if (replaceAir)
+    {
+        replace |= TileTraits::ALL_TYPES & ~SOLID_TYPES;
+    }
+    if (overrideBlocks)
+    {
+        replace |= SOLID_TYPES;
+    }
+    return replace;
+}
 
 void WorldGenerator::FillBlob(
     int x, int y, Tile::Type type, double radius, double variation, bool replaceAir, bool overrideBlocks)
 {
-    int r = static_cast<int>(radius / 2);
-    for (int i = x - r; i < x + r; ++i)
-    {
-        for (int j = y - r; j < y + r; ++j)
+    m_blobStamper.Stamp(
+        m_tiles,
+        static_cast<int>(m_width),
+        static_cast<int>(m_height),
+        BlobStamper::Blob{x, y, type, radius, variation, BlobReplaceSet(replaceAir, overrideBlocks)},
+        m_random);
+    const int r = static_cast<int>(radius / 2) + 1;
+    TilesChanged(x - r, y - r, x + r, y + r);
+}
+
+// Runs evaluate(x, y) on the rows [rows(x).x, rows(x).y) of every column, but only where the tile's current type is in
+// precondition. Passes use this to keep noise evaluation away from tiles their result could never change.
+// Tiles are visited row by row so the precondition loads stream through memory; evaluate must only depend on the
+// tile it is given (and tiles below it that the pass does not change). The region is column-local, so it can run as
+// part of a strip; rows and evaluate are kept until then and must not refer to the caller's locals.
+template <class Rows, class Evaluate>
+void WorldGenerator::ForEachInRegion(const char* pass, Rows rows, TileTraits::TypeSet precondition, Evaluate evaluate)
+{
+    const std::size_t entry = m_regionStats.size();
+    m_regionStats.push_back(RegionStats{pass, 0, m_tiles.size()});
+
+    RunColumns([=, this](Vector2<int> columns) {
+        const int count = columns.y - columns.x;
+        std::vector<Vector2<int>> spans(count);
+        int top = static_cast<int>(m_height);
+        int bottom = 0;
+        for (int i = 0; i < count; ++i)
         {
-            double distance = std::sqrt(std::pow(i - x, 2) + std::pow(j - y, 2));
-            distance *= 2 / radius;
-            double rand = m_random.GetDouble(0, variation);
+            const Vector2<int> span = rows(columns.x + i);
+            spans[i] = Vector2<int>{std::max(span.x, 0), std::min(span.y, static_cast<int>(m_height))};
+            top = std::min(top, spans[i].x);
+            bottom = std::max(bottom, spans[i].y);
+        }
 
-            // Distance is the distance from 0 (center) to 1 (max radius)
-            // Rand is a random value based on variation
-            double check = distance + rand;
-            bool isAir = IsTile(i, j, Tile::Type::Air);
-            if (replaceAir && isAir || overrideBlocks && !isAir)
+        std::size_t evaluated = 0;
+        for (int y = top; y < bottom; ++y)
+        {
+            const Tile* row = &m_tiles[m_width * y + columns.x];
+            for (int i = 0; i < count; ++i)
+            {
+                if (y >= spans[i].x && y < spans[i].y && TileTraits::InSet(row[i].m_type, precondition))
+                {
+                    ++evaluated;
+                    evaluate(columns.x + i, y);
+                }
+            }
+        }
+
+        std::lock_guard lock{m_statsMutex};
+        m_regionStats[entry].evaluated += evaluated;
+        m_regionStats[entry].skipped -= evaluated;
+    });
+}
+
+// Flat indexes of the tiles in the half-open rows whose bit edges(word, y) sets, a word of tiles at a time. Every chunk
+// of rows lists its own, and the lists are joined in row order so the result does not depend on the threads
+template <class Edges>
+std::vector<std::uint32_t> WorldGenerator::SweepCandidates(Vector2<int> rows, Edges edges) const
+{
+    constexpr std::size_t ROWS_PER_TASK = 16;
+    constexpr int WORD_BITS = 64;
+
+    const int top = std::max(rows.x, 0);
+    const int bottom = std::min(rows.y, static_cast<int>(m_height));
+    if (top >= bottom)
+    {
+        return {};
+    }
+    const int words = (static_cast<int>(m_width) + WORD_BITS - 1) / WORD_BITS;
+    std::vector<std::vector<std::uint32_t>> found((bottom - top + ROWS_PER_TASK - 1) / ROWS_PER_TASK);
+    Parallel::ForRange(bottom - top, ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        std::vector<std::uint32_t>& list = found[begin / ROWS_PER_TASK];
+        for (int y = top + static_cast<int>(begin); y < top + static_cast<int>(end); ++y)
+        {
+            for (int word = 0; word < words; ++word)
             {
-                if (check < 1)
+                std::uint64_t bits = edges(word, y);
+                while (bits != 0)
                 {
-                    SetTile(i, j, type);
+                    list.push_back(static_cast<std::uint32_t>(word * WORD_BITS + std::countr_zero(bits) + m_width * y));
+                    bits &= bits - 1;
                 }
             }
         }
+    });
+    std::vector<std::uint32_t> candidates;
+    for (const std::vector<std::uint32_t>& list : found)
+    {
+        candidates.insert(candidates.end(), list.begin(), list.end());
     }
+    return candidates;
 }
 
 // Helper Functions
+DistanceField WorldGenerator::DistanceTo(TileTraits::TypeSet features) const
+{
+    return DistanceField{m_tiles, static_cast<int>(m_width), static_cast<int>(m_height), features};
+}
+
+std::uint32_t WorldGenerator::CountTypes(TileTraits::TypeSet types, Vector2<int> horizontal, Vector2<int> vertical)
+{
+    return m_counts.Count(m_tiles, types, horizontal, vertical);
+}
+
+BiomeMap::Biome WorldGenerator::GetBiome(int x, int y) const
+{
+    return m_biomes.At(x, y);
+}
+
+double WorldGenerator::GetBiomeWeight(BiomeMap::Biome biome, int x, int y) const
+{
+    return m_biomes.Weight(biome, x, y);
+}
+
+void WorldGenerator::DigTunnels(const std::vector<Tunneler::Worm>& worms)
+{
+    const Vector2<int> rows = Tunneler::Dig(
+        m_tiles,
+        static_cast<int>(m_width),
+        static_cast<int>(m_height),
+        worms,
+        TileTraits::SetOf(TileTraits::SOLID),
+        Tile::Type::Air);
+    TilesChanged(0, rows.x, static_cast<int>(m_width), rows.y);
+}
+
+void WorldGenerator::TilesChanged(int left, int top, int right, int bottom)
+{
+    m_surface.Refresh(m_tiles, left, top, right, bottom);
+    m_counts.Invalidate(left, top, right, bottom);
+}
+
+void WorldGenerator::RemapTypes(const TypeRemap::Table& table, Vector2<int> horizontal, Vector2<int> vertical)
+{
+    RunColumns([=, this](Vector2<int> columns) {
+        const Vector2<int> strip{std::max(horizontal.x, columns.x), std::min(horizontal.y, columns.y)};
+        TypeRemap::Apply(m_tiles, static_cast<int>(m_width), table, strip, vertical);
+        TilesChanged(strip.x, vertical.x, strip.y, vertical.y);
+    });
+}
+
+void WorldGenerator::RemapTypes(const TypeRemap::Table& table, const Bitplane& mask, Vector2<int> rows)
+{
+    TypeRemap::Apply(m_tiles, table, mask, rows);
+    TilesChanged(0, rows.x, static_cast<int>(m_width), rows.y);
+}
+
+FloodFill::Result WorldGenerator::FillBasin(Vector2<int> seed, Tile::Liquid liquid, double volume)
+{
+    return FloodFill::Fill(m_tiles, static_cast<int>(m_width), static_cast<int>(m_height), seed, liquid, volume);
+}
+
+void WorldGenerator::PlacePrefab(const Prefab& prefab, Vector2<int> position, bool flipX, bool flipY)
+{
+    prefab.Blit(m_tiles, static_cast<int>(m_width), static_cast<int>(m_height), position, flipX, flipY);
+    TilesChanged(position.x, position.y, position.x + prefab.GetWidth(), position.y + prefab.GetHeight());
+}
+
 int WorldGenerator::RandomHeight(double min, double max)
 {
     return static_cast<int>(static_cast<double>(m_height) * m_random.GetDouble(min, max));
@@ -111,7 +359,7 @@ std::vector<int> WorldGenerator::RandomTerrain(int minHeight, int maxHeight, dou
 
     const int goalTimerOffset = timer / 4;
 
-    std::vector<int> terrainHeight(m_width);
+    std::vector<double> profile(m_width);
 
     const int bounds = (maxHeight - minHeight) / 4;
     const int r = static_cast<int>(m_random.Next());
@@ -160,11 +408,31 @@ std::vector<int> WorldGenerator::RandomTerrain(int minHeight, int maxHeight, dou
         {
             height = maxHeight;
         }
-        terrainHeight[x] = static_cast<int>(height + noise);
+        profile[x] = height + noise;
     }
 
+    if (m_erosion)
+    {
+        // Knocks the single-column spikes and steps off the walk while keeping its hills
+        constexpr Erosion::Thermal THERMAL{1.0, 0.5, 16};
+        constexpr Erosion::Hydraulic HYDRAULIC{0.01, 0.5, 0.3, 0.3, 0.05, 32};
+        Erosion::ErodeProfile(profile, THERMAL, HYDRAULIC);
+    }
+
+    std::vector<int> terrainHeight(m_width);
+    std::transform(profile.begin(), profile.end(), terrainHeight.begin(), [](double row) {
+        return static_cast<int>(row);
+    });
+
     return std::move(terrainHeight);
 }
+
+void WorldGenerator::ErodeSurface(int rows, int talus, int steps)
+{
+    rows = std::clamp(rows, 0, static_cast<int>(m_height));
+    Erosion::ErodeTiles(m_tiles, static_cast<int>(m_width), rows, talus, steps);
+    TilesChanged(0, 0, static_cast<int>(m_width), rows);
+}
 #pragma endregion Main Functions
 
 // Terrain, Dirt, Stone, and Sand
@@ -172,83 +440,91 @@ std::vector<int> WorldGenerator::RandomTerrain(int minHeight, int maxHeight, dou
 void WorldGenerator::GenerateDepthLevels(int surface, int cavern, int underworld)
 {
     const int space = static_cast<int>(surface * 0.35);
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = 0; y < space; ++y)
-        {
-            SetDepth(x, y, Tile::Depth::Space);
-        }
-        for (int y = space; y < surface; ++y)
+    RunColumns([=, this](Vector2<int> columns) {
+        for (int x = columns.x; x < columns.y; ++x)
         {
-            SetDepth(x, y, Tile::Depth::Overworld);
-        }
-        for (int y = surface; y < cavern; ++y)
-        {
-            SetDepth(x, y, Tile::Depth::Underground);
-        }
-        for (int y = cavern; y < underworld; ++y)
-        {
-            SetDepth(x, y, Tile::Depth::Cavern);
-        }
-        for (int y = underworld; y < m_height; ++y)
-        {
-            SetDepth(x, y, Tile::Depth::Underworld);
+            for (int y = 0; y < space; ++y)
+            {
+                SetDepth(x, y, Tile::Depth::Space);
+            }
+            for (int y = space; y < surface; ++y)
+            {
+                SetDepth(x, y, Tile::Depth::Overworld);
+            }
+            for (int y = surface; y < cavern; ++y)
+            {
+                SetDepth(x, y, Tile::Depth::Underground);
+            }
+            for (int y = cavern; y < underworld; ++y)
+            {
+                SetDepth(x, y, Tile::Depth::Cavern);
+            }
+            for (int y = underworld; y < m_height; ++y)
+            {
+                SetDepth(x, y, Tile::Depth::Underworld);
+            }
         }
-    }
+    });
 }
 
 void WorldGenerator::GenerateLayers(const std::vector<int>& dirtTerrain, const std::vector<int>& stoneTerrain, int ash)
 {
-    for (int x = 0; x < m_width; ++x)
-    {
-        const int dirt = dirtTerrain[x];
-        const int stone = stoneTerrain[x];
-        for (int y = 0; y < dirt; ++y)
-        {
-            SetTile(x, y, Tile::Type::Air);
-        }
-        SetTile(x, dirt, Tile::Type::Grass);
-        for (int y = dirt + 1; y < stone; ++y)
+    RunColumns([=, this](Vector2<int> columns) {
+        for (int x = columns.x; x < columns.y; ++x)
         {
-            SetTile(x, y, Tile::Type::Dirt);
-        }
-        for (int y = stone; y < ash; ++y)
-        {
-            SetTile(x, y, Tile::Type::Stone);
-        }
-        for (int y = ash; y < m_height; ++y)
-        {
-            SetTile(x, y, Tile::Type::Ash);
+            const int dirt = dirtTerrain[x];
+            const int stone = stoneTerrain[x];
+            for (int y = 0; y < dirt; ++y)
+            {
+                SetTile(x, y, Tile::Type::Air);
+            }
+            SetTile(x, dirt, Tile::Type::Grass);
+            for (int y = dirt + 1; y < stone; ++y)
+            {
+                SetTile(x, y, Tile::Type::Dirt);
+            }
+            for (int y = stone; y < ash; ++y)
+            {
+                SetTile(x, y, Tile::Type::Stone);
+            }
+            for (int y = ash; y < m_height; ++y)
+            {
+                SetTile(x, y, Tile::Type::Ash);
+            }
         }
-    }
+    });
+    m_placement.SetSurface(0, static_cast<int>(m_width), Tile::Type::Grass);
 }
 
-int WorldGenerator::ComputeStartCoordinate(int side)
+Vector2<int> WorldGenerator::ComputeStartRange(int side) const
 {
     constexpr int WORLD_START_OFFSET = 50;
     if (side % 2 == 0)
     {
         // Left side of world
-        return m_random.GetInt(WORLD_START_OFFSET, static_cast<int>(m_width / 2) - WORLD_START_OFFSET * 2);
+        return Vector2<int>{WORLD_START_OFFSET, static_cast<int>(m_width / 2) - WORLD_START_OFFSET * 2};
     }
 
     // Right side of world
-    return m_random.GetInt(
-        static_cast<int>(m_width / 2) + WORLD_START_OFFSET * 2, static_cast<int>(m_width) - WORLD_START_OFFSET);
+    return Vector2<int>{
+        static_cast<int>(m_width / 2) + WORLD_START_OFFSET * 2, static_cast<int>(m_width) - WORLD_START_OFFSET};
 }
 
-int WorldGenerator::ComputeWithinUsableArea(const std::vector<int>& surfaceTerrain, int side, int size, Tile::Type mask)
+std::optional<int> WorldGenerator::ComputeWithinUsableArea(int side, int size, TileTraits::TypeSet forbiddenEnds)
 {
-    if (mask == Tile::Type::Air)
-    {
-        return ComputeStartCoordinate(side);
-    }
-    while (true)
+    return m_placement.Sample(ComputeStartRange(side), size, forbiddenEnds, m_random);
+}
+
+// Marks a structure's columns as taken and records the surface types it left behind
+void WorldGenerator::ClaimSurface(int start, int size)
+{
+    m_placement.Occupy(start, start + size + 1);
+    for (int x = start; x <= start + size && x < m_width; ++x)
     {
-        int start = ComputeStartCoordinate(side);
-        if (!(IsTile(start, surfaceTerrain[start], mask) || IsTile(start + size, surfaceTerrain[start + size], mask)))
+        const int top = m_surface.Top(x);
+        if (top < m_height)
         {
-            return start;
+            m_placement.SetSurface(x, x + 1, m_tiles[x + m_width * top].m_type);
         }
     }
 }
@@ -261,6 +537,8 @@ void WorldGenerator::GenerateSurfaceTunnels(const std::vector<int>& surfaceTerra
     constexpr double TUNNEL_NOISE_SCALE = 1.5;
     constexpr int TUNNEL_OFFSET = 1;
 
+    constexpr TileTraits::TypeSet SAND = TileTraits::MakeSet({Tile::Type::Sand});
+
     const int tunnelCount = m_random.GetInt(6, 10);
     const int r1 = static_cast<int>(m_random.Next());
     const int r2 = static_cast<int>(m_random.Next());
@@ -268,7 +546,13 @@ void WorldGenerator::GenerateSurfaceTunnels(const std::vector<int>& surfaceTerra
     for (int i = 0; i < tunnelCount; ++i)
     {
         int size = m_random.GetInt(TUNNEL_SIZE_MIN, TUNNEL_SIZE_MAX);
-        int start = ComputeWithinUsableArea(surfaceTerrain, i, size, Tile::Type::Sand);
+        const std::optional<int> placement = ComputeWithinUsableArea(i, size, SAND);
+        if (!placement)
+        {
+            // No room left on this side of the world
+            continue;
+        }
+        int start = *placement;
 
         const int spacing = 6;
         for (int x = start; x < start + size; ++x)
@@ -303,6 +587,7 @@ void WorldGenerator::GenerateSurfaceTunnels(const std::vector<int>& surfaceTerra
                 }
             }
         }
+        ClaimSurface(start, size);
     }
 }
 
@@ -318,7 +603,12 @@ void WorldGenerator::GenerateSandDesert(const std::vector<int>& surfaceTerrain)
     for (int i = 0; i < desertCount; ++i)
     {
         int size = m_random.GetInt(DESERT_SIZE_MIN, DESERT_SIZE_MAX);
-        int start = ComputeWithinUsableArea(surfaceTerrain, i, size);
+        const std::optional<int> placement = ComputeWithinUsableArea(i, size);
+        if (!placement)
+        {
+            continue;
+        }
+        int start = *placement;
 
         int depth = surfaceTerrain[start] + DESERT_MAX_OFFSET_CORRECTION;
         for (int x = start; x < start + size; ++x)
@@ -351,6 +641,7 @@ void WorldGenerator::GenerateSandDesert(const std::vector<int>& surfaceTerrain)
                 SetTile(x, y, Tile::Type::Sand);
             }
         }
+        ClaimSurface(start, size);
     }
 }
 
@@ -361,15 +652,35 @@ void WorldGenerator::GenerateSandPiles(int dirtLevel, const std::vector<int>& ro
     constexpr int SAND_PILE_OVERCORRECTION = 40;
     constexpr int SAND_PILE_MAX_OFFSET = 5;
     constexpr int SAND_PILE_PROXIMITY_THRESHOLD = 30;
+    constexpr double NOISE_MAX = 1;
 
     int mid = dirtLevel;
     const auto& end = rockHeights;
 
-    for (int x = 0; x < m_width; ++x)
+    // Noise never goes above NOISE_MAX, so rows where the edge falloff alone keeps it under the cutoff are skipped
+    int topTrim = 0;
+    while (topTrim <= SAND_PILE_MAX_OFFSET &&
+           NOISE_MAX - static_cast<double>(SAND_PILE_MAX_OFFSET - topTrim) / SAND_PILE_PROXIMITY_THRESHOLD <=
+               SAND_PILE_CUTOFF)
     {
-        int bottom = end[x] + SAND_PILE_OVERCORRECTION;
-        for (int y = mid; y < bottom; ++y)
-        {
+        ++topTrim;
+    }
+    int bottomTrim = 0;
+    while (bottomTrim < SAND_PILE_MAX_OFFSET &&
+           NOISE_MAX - static_cast<double>(SAND_PILE_MAX_OFFSET - bottomTrim) / SAND_PILE_PROXIMITY_THRESHOLD <=
+               SAND_PILE_CUTOFF)
+    {
+        ++bottomTrim;
+    }
+
+    ForEachInRegion(
+        "SandPiles",
+        [=](int x) {
+            return Vector2<int>{mid + topTrim, end[x] + SAND_PILE_OVERCORRECTION - bottomTrim};
+        },
+        TileTraits::ALL_TYPES & ~TileTraits::MakeSet({Tile::Type::Sand}),
+        [=, this](int x, int y) {
+            const int bottom = end[x] + SAND_PILE_OVERCORRECTION;
             double noise = m_random.GetNoise(x * SAND_PILE_SCALE, y * SAND_PILE_SCALE);
             if (y - mid <= SAND_PILE_MAX_OFFSET)
             {
@@ -385,8 +696,7 @@ void WorldGenerator::GenerateSandPiles(int dirtLevel, const std::vector<int>& ro
             {
                 SetTile(x, y, Tile::Type::Sand);
             }
-        }
-    }
+        });
 }
 
 static int AnthillCount(WorldSize size)
@@ -407,15 +717,23 @@ std::vector<int> WorldGenerator::GenerateAnthills(const std::vector<int>& surfac
     constexpr double ANTHILL_HEIGHT = 20;
     constexpr int ANTHILL_SIZE_MIN = 40;
     constexpr int ANTHILL_SIZE_MAX = 60;
+    constexpr TileTraits::TypeSet SAND = TileTraits::MakeSet({Tile::Type::Sand});
 
     int anthillCount = AnthillCount(m_size);
 
-    std::vector<int> anthillCavePositions(static_cast<size_t>(anthillCount * 2));
+    // Pairs of x, y; anthills that found no room are left out
+    std::vector<int> anthillCavePositions;
+    anthillCavePositions.reserve(static_cast<size_t>(anthillCount * 2));
 
     for (int i = 0; i < anthillCount; ++i)
     {
         int size = m_random.GetInt(ANTHILL_SIZE_MIN, ANTHILL_SIZE_MAX);
-        int start = ComputeWithinUsableArea(surfaceTerrain, i, size, Tile::Type::Sand);
+        const std::optional<int> placement = ComputeWithinUsableArea(i, size, SAND);
+        if (!placement)
+        {
+            continue;
+        }
+        int start = *placement;
 
         for (int x = start; x < start + size; ++x)
         {
@@ -445,9 +763,11 @@ std::vector<int> WorldGenerator::GenerateAnthills(const std::vector<int>& surfac
             }
         }
 
+        ClaimSurface(start, size);
+
         const int mid = start + size / 2;
-        anthillCavePositions[static_cast<size_t>(i) * 2] = mid;
-        anthillCavePositions[i * 2 + 1] = surfaceTerrain[mid] - size / 4;
+        anthillCavePositions.push_back(mid);
+        anthillCavePositions.push_back(surfaceTerrain[mid] - size / 4);
     }
 
     return std::move(anthillCavePositions);
@@ -460,20 +780,17 @@ void WorldGenerator::GenerateSurfaceStone(const std::vector<int>& start, const s
 
     const int offset = static_cast<int>(m_random.Next());
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = start[x]; y < end[x]; ++y)
-        {
+    ForEachInRegion(
+        "SurfaceStone",
+        [=](int x) { return Vector2<int>{start[x], end[x]}; },
+        TileTraits::MakeSet({Tile::Type::Dirt}),
+        [=, this](int x, int y) {
             double noise = m_random.GetNoise(x * SURFACE_STONE_SCALE, y * SURFACE_STONE_SCALE + offset);
             if (noise > SURFACE_STONE_CUTOFF)
             {
-                if (IsTile(x, y, Tile::Type::Dirt))
-                {
-                    SetTile(x, y, Tile::Type::Stone);
-                }
+                SetTile(x, y, Tile::Type::Stone);
             }
-        }
-    }
+        });
 }
 
 void WorldGenerator::GenerateUndergroundStone(const std::vector<int>& start, const std::vector<int>& end)
@@ -483,10 +800,11 @@ void WorldGenerator::GenerateUndergroundStone(const std::vector<int>& start, con
 
     const int offset = static_cast<int>(m_random.Next());
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = start[x]; y < end[x]; ++y)
-        {
+    ForEachInRegion(
+        "UndergroundStone",
+        [=](int x) { return Vector2<int>{start[x], end[x]}; },
+        TileTraits::ALL_TYPES & ~TileTraits::MakeSet({Tile::Type::Stone}),
+        [=, this](int x, int y) {
             const double noiseScale1 =
                 m_random.GetNoise(x * UNDERGROUND_STONE_SCALE, y * UNDERGROUND_STONE_SCALE + offset);
             const double noiseScale2 =
@@ -499,8 +817,7 @@ void WorldGenerator::GenerateUndergroundStone(const std::vector<int>& start, con
             {
                 SetTile(x, y, Tile::Type::Stone);
             }
-        }
-    }
+        });
 }
 
 void WorldGenerator::GenerateCavernDirt(const std::vector<int>& start, int end)
@@ -510,10 +827,11 @@ void WorldGenerator::GenerateCavernDirt(const std::vector<int>& start, int end)
 
     const int offset = static_cast<int>(m_random.Next());
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = start[x]; y < end; ++y)
-        {
+    ForEachInRegion(
+        "CavernDirt",
+        [=](int x) { return Vector2<int>{start[x], end}; },
+        TileTraits::ALL_TYPES & ~TileTraits::MakeSet({Tile::Type::Dirt}),
+        [=, this](int x, int y) {
             const double noiseScale1 = m_random.GetNoise(x * CAVERN_DIRT_SCALE, y * CAVERN_DIRT_SCALE + offset);
             const double noiseScale2 =
                 m_random.GetNoise(x * CAVERN_DIRT_SCALE / 2, y * CAVERN_DIRT_SCALE / 2 + offset) / 2;
@@ -527,24 +845,25 @@ void WorldGenerator::GenerateCavernDirt(const std::vector<int>& start, int end)
             {
                 SetTile(x, y, Tile::Type::Dirt);
             }
-        }
-    }
+        });
 }
 #pragma endregion
 
 // Small, Large, and Entrance Caves
 #pragma region Caves
-void WorldGenerator::GenerateCaves(const std::vector<int>& undergroundStart)
+void WorldGenerator::GenerateCaves(const std::vector<int>& undergroundStart, int underworld)
 {
     constexpr double CAVE_SCALE = 5;
     constexpr double CAVE_SCALE_HORIZONTAL = 7.5;
     constexpr double CAVE_SCALE_VERTICAL = 3.3;
     constexpr double CAVE_CUTOFF = 0.65;
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = undergroundStart[x]; y < m_height; ++y)
-        {
+    // The underworld is left for its own pass; tiles that are already open have nothing to carve
+    ForEachInRegion(
+        "Caves",
+        [=](int x) { return Vector2<int>{undergroundStart[x], underworld}; },
+        TileTraits::SetOf(TileTraits::SOLID),
+        [=, this](int x, int y) {
             double noise_scale_1 = m_random.GetNoise(x * CAVE_SCALE_HORIZONTAL, y * CAVE_SCALE);
             double noise_scale_2 = m_random.GetNoise(x * CAVE_SCALE, y * CAVE_SCALE_VERTICAL) / 2;
 
@@ -554,23 +873,52 @@ void WorldGenerator::GenerateCaves(const std::vector<int>& undergroundStart)
                 // Some caves should be water, some lava, and the rest air. How to disinguish caves?
                 SetTile(x, y, Tile::Type::Air);
             }
-        }
-    }
+        });
 }
 
-void WorldGenerator::GenerateEntranceCaves(const std::vector<int>& surface)
+void WorldGenerator::GenerateEntranceCaves()
 {
+    constexpr int COLUMNS_PER_CAVE = 350;
+    constexpr int DEPTH_ABOVE_SURFACE = 3;
+    constexpr double HEADING_SPREAD = 0.5;
+    constexpr double PULL = 0.05;
+    constexpr double TURN = 0.35;
+    constexpr Vector2<int> STEPS{60, 140};
+    constexpr double STEP_LENGTH = 2;
+    constexpr Vector2<double> RADIUS{2.5, 5};
+
+    // Alternating sides like the other surface structures, so the middle of the world stays clear
+    std::vector<Tunneler::Worm> worms;
+    const int caveCount = static_cast<int>(m_width) / COLUMNS_PER_CAVE;
+    for (int i = 0; i < caveCount; ++i)
+    {
+        const int x = m_random.GetInt(ComputeStartRange(i));
+        const double heading = std::numbers::pi / 2 + m_random.GetDouble(-HEADING_SPREAD, HEADING_SPREAD);
+        const int steps = m_random.GetInt(STEPS);
+        worms.push_back(Tunneler::Worm{
+            Vector2<double>{x + 0.5, static_cast<double>(m_surface.Top(x) - DEPTH_ABOVE_SURFACE)},
+            heading,
+            std::numbers::pi / 2,
+            PULL,
+            TURN,
+            steps,
+            STEP_LENGTH,
+            RADIUS,
+            m_random.Next()});
+    }
+    DigTunnels(worms);
 }
 
-void WorldGenerator::GenerateLargeCaves(const std::vector<int>& cavernStart)
+void WorldGenerator::GenerateLargeCaves(const std::vector<int>& cavernStart, int underworld)
 {
     constexpr double LARGE_CAVE_SCALE = 4;
     constexpr double LARGE_CAVE_CUTOFF = 0.7;
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = cavernStart[x]; y < m_height; ++y)
-        {
+    ForEachInRegion(
+        "LargeCaves",
+        [=](int x) { return Vector2<int>{cavernStart[x], underworld}; },
+        TileTraits::SetOf(TileTraits::SOLID),
+        [=, this](int x, int y) {
             double noise_scale_1 = m_random.GetNoise(x * LARGE_CAVE_SCALE, y * LARGE_CAVE_SCALE);
             double noise_scale_2 = m_random.GetNoise(x * LARGE_CAVE_SCALE / 2, y * LARGE_CAVE_SCALE / 2) / 2;
 
@@ -580,8 +928,68 @@ void WorldGenerator::GenerateLargeCaves(const std::vector<int>& cavernStart)
                 // Some caves should be water, some lava, and the rest air. How to disinguish caves?
                 SetTile(x, y, Tile::Type::Air);
             }
+        });
+}
+
+void WorldGenerator::SmoothCaves(int top, int bottom)
+{
+    constexpr int SMOOTHING_STEPS = 2;
+    // Open tiles with 5+ open neighbours open up and ones with fewer than 4 fill in: speckle and spikes go away
+    constexpr Automaton::Rule CAVE_RULE{0b111100000, 0b111110000};
+    constexpr TileTraits::TypeSet OPEN = TileTraits::ALL_TYPES & ~TileTraits::SetOf(TileTraits::SOLID);
+    constexpr int WORD_BITS = 64;
+    constexpr std::size_t ROWS_PER_TASK = 16;
+
+    const int width = static_cast<int>(m_width);
+    const Bitplane before = Bitplane::FromTypes(m_tiles, width, static_cast<int>(m_height), OPEN);
+    Bitplane after = before;
+    Automaton::Run(after, CAVE_RULE, SMOOTHING_STEPS, Vector2<int>{top, bottom}, false);
+
+    // Filled tiles copy a neighbour that is solid before and after, which no task writes to
+    const auto fillType = [&](int x, int y) {
+        for (const Vector2<int> offset : {Vector2<int>{0, 1}, {0, -1}, {-1, 0}, {1, 0}})
+        {
+            const int nx = x + offset.x;
+            const int ny = y + offset.y;
+            if (nx >= 0 && nx < width && ny >= 0 && ny < static_cast<int>(m_height) && !before.Get(nx, ny) &&
+                !after.Get(nx, ny))
+            {
+                return m_tiles[nx + m_width * ny].m_type;
+            }
         }
-    }
+        return Tile::Type::Stone;
+    };
+
+    const int first = std::max(top, 0);
+    const int last = std::min(bottom, static_cast<int>(m_height));
+    Parallel::ForRange(std::max(last - first, 0), ROWS_PER_TASK, [&](std::size_t begin, std::size_t end) {
+        for (int y = first + static_cast<int>(begin); y < first + static_cast<int>(end); ++y)
+        {
+            for (int word = 0; word < before.GetWords(); ++word)
+            {
+                const std::uint64_t opened = after.Row(y)[word];
+                std::uint64_t changed = before.Row(y)[word] ^ opened;
+                while (changed != 0)
+                {
+                    const int bit = std::countr_zero(changed);
+                    changed &= changed - 1;
+                    const int x = word * WORD_BITS + bit;
+                    m_tiles[x + m_width * y].m_type = ((opened >> bit) & 1U) != 0 ? Tile::Type::Air : fillType(x, y);
+                }
+            }
+        }
+    });
+    // Rows are written from several tasks, so the indexes catch up once they are done
+    TilesChanged(0, first, width, last);
+}
+
+Caves::Labels WorldGenerator::LabelCaves() const
+{
+    return Caves::Label(
+        m_tiles,
+        static_cast<int>(m_width),
+        static_cast<int>(m_height),
+        TileTraits::ALL_TYPES & ~TileTraits::SetOf(TileTraits::SOLID));
 }
 #pragma endregion Caves
 
@@ -597,50 +1005,44 @@ void WorldGenerator::GenerateClay(
     constexpr int MID_OFFSET = 10;
     constexpr int END_OFFSET = 30;
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = start[x] + START_OFFSET; y < mid[x] + MID_OFFSET; ++y)
-        {
+    ForEachInRegion(
+        "ClayUpper",
+        [=](int x) { return Vector2<int>{start[x] + START_OFFSET, mid[x] + MID_OFFSET}; },
+        TileTraits::SetOf(TileTraits::CLAY_REPLACEABLE),
+        [=, this](int x, int y) {
             double n = m_random.GetNoise(x * CLAY_SCALE, y * CLAY_SCALE);
-            if (n < CLAY_CUTOFF1)
+            if (n >= CLAY_CUTOFF1)
             {
-                continue;
-            }
-            int pos = static_cast<int>(x + m_width * y);
-            switch (m_tiles[pos].m_type)
-            {
-            case Tile::Type::Dirt:
-            case Tile::Type::Stone:
                 SetTile(x, y, Tile::Type::Clay);
-            default:
-                break;
-            };
-        }
-        for (int y = mid[x] + MID_OFFSET; y < end[x] + END_OFFSET; ++y)
-        {
+            }
+        });
+    ForEachInRegion(
+        "ClayLower",
+        [=](int x) { return Vector2<int>{mid[x] + MID_OFFSET, end[x] + END_OFFSET}; },
+        TileTraits::ALL_TYPES & ~TileTraits::MakeSet({Tile::Type::Clay}),
+        [=, this](int x, int y) {
             double n = m_random.GetNoise(x * CLAY_SCALE, y * CLAY_SCALE);
-            if (n < CLAY_CUTOFF2)
+            if (n >= CLAY_CUTOFF2)
             {
-                continue;
+                SetTile(x, y, Tile::Type::Clay);
             }
-            SetTile(x, y, Tile::Type::Clay);
-        }
-    }
+        });
 }
 
 void WorldGenerator::GenerateGrass(const std::vector<int>& start, int end)
 {
     constexpr double CHANCE_OF_GRASS = 0.025;
 
+    SparseSampler sampler{m_random, CHANCE_OF_GRASS};
     for (int x = 0; x < m_width; ++x)
     {
-        for (int y = start[x]; y < end; y++)
-        {
-            if (IsTile(x, y, Tile::Type::Dirt), CHANCE_OF_GRASS > m_random.GetDouble(0, 1))
+        sampler.Run(end - start[x], [&](std::int64_t i) {
+            const int y = start[x] + static_cast<int>(i);
+            if (IsTile(x, y, Tile::Type::Dirt))
             {
                 SetTile(x, y, Tile::Type::Grass);
             }
-        }
+        });
     }
 }
 
@@ -652,17 +1054,17 @@ void WorldGenerator::GenerateMud(int start, int end)
 
     const int r = m_random.Next();
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = start; y < end; y++)
-        {
+    ForEachInRegion(
+        "Mud",
+        [=](int /*x*/) { return Vector2<int>{start, end}; },
+        TileTraits::SetOf(TileTraits::SOLID) & ~TileTraits::MakeSet({Tile::Type::Mud}),
+        [=, this](int x, int y) {
             const double noise = m_random.GetNoise(x * MUD_SCALE_X, y * MUD_SCALE_Y + r);
-            if (MUD_CUTOFF < noise && !IsTile(x, y, Tile::Type::Air))
+            if (MUD_CUTOFF < noise)
             {
                 SetTile(x, y, Tile::Type::Mud);
             }
-        }
-    }
+        });
 }
 
 void WorldGenerator::GenerateSilt(int start, int end)
@@ -672,17 +1074,21 @@ void WorldGenerator::GenerateSilt(int start, int end)
 
     const int r = m_random.Next();
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = start; y < end; y++)
-        {
+    ForEachInRegion(
+        "Silt",
+        [=](int /*x*/) { return Vector2<int>{start, end}; },
+        TileTraits::SetOf(TileTraits::SOLID) & ~TileTraits::MakeSet({Tile::Type::Silt}),
+        [=, this](int x, int y) {
+            if (!HasTrait(x, y + 1, TileTraits::SOLID))
+            {
+                return;
+            }
             const double noise = m_random.GetNoise(x * SILT_SCALE, y * SILT_SCALE + r);
-            if (SILT_CUTOFF < noise && !IsTile(x, y, Tile::Type::Air) && !IsTile(x, y + 1, Tile::Type::Air))
+            if (SILT_CUTOFF < noise)
             {
                 SetTile(x, y, Tile::Type::Silt);
             }
-        }
-    }
+        });
 }
 #pragma endregion Scattered Blocks
 
@@ -725,27 +1131,6 @@ void WorldGenerator::GenerateMetals(int surface, int underground, int cavern, in
     constexpr Vector2<double> COPPER_CAVERN_SIZE = Vector2<double>{4, 9};
     constexpr Vector2<double> COPPER_CAVERN_VARIATION = Vector2<double>{0.1, 0.4};
 
-    const int copperSurfaceCount = static_cast<int>(static_cast<double>(m_tiles.size()) * COPPER_SURFACE_AMOUNT);
-    const int copperUndergroundCount =
-        static_cast<int>(static_cast<double>(m_tiles.size()) * COPPER_UNDERGROUND_AMOUNT);
-    const int copperCavernCount = static_cast<int>(static_cast<double>(m_tiles.size()) * COPPER_CAVERN_AMOUNT);
-    // COPPER
-    for (int i = 0; i < copperSurfaceCount; ++i)
-    {
-        FillBlobAtRandomPosition(
-            worldWidth, surfaceHeight, Tile::Type::Copper, COPPER_SURFACE_SIZE, COPPER_SURFACE_VARIATION);
-    }
-    for (int i = 0; i < copperUndergroundCount; ++i)
-    {
-        FillBlobAtRandomPosition(
-            worldWidth, undergroundHeight, Tile::Type::Copper, COPPER_UNDERGROUND_SIZE, COPPER_UNDERGROUND_VARIATION);
-    }
-    for (int i = 0; i < copperCavernCount; ++i)
-    {
-        FillBlobAtRandomPosition(
-            worldWidth, cavernHeight, Tile::Type::Copper, COPPER_CAVERN_SIZE, COPPER_CAVERN_VARIATION);
-    }
-
     constexpr double IRON_SURFACE_AMOUNT = 8E-05;
     constexpr Vector2<double> IRON_SURFACE_SIZE = Vector2<double>{3, 7};
     constexpr Vector2<double> IRON_SURFACE_VARIATION = Vector2<double>{0.1, 0.4};
@@ -756,25 +1141,6 @@ void WorldGenerator::GenerateMetals(int surface, int underground, int cavern, in
     constexpr Vector2<double> IRON_CAVERN_SIZE = Vector2<double>{4, 9};
     constexpr Vector2<double> IRON_CAVERN_VARIATION = Vector2<double>{0.1, 0.4};
 
-    const int ironSurfaceCount = static_cast<int>(static_cast<double>(m_tiles.size()) * IRON_SURFACE_AMOUNT);
-    const int ironUndergroundCount = static_cast<int>(static_cast<double>(m_tiles.size()) * IRON_UNDERGROUND_AMOUNT);
-    const int ironCavernCount = static_cast<int>(static_cast<double>(m_tiles.size()) * IRON_CAVERN_AMOUNT);
-    // IRON
-    for (int i = 0; i < ironSurfaceCount; ++i)
-    {
-        FillBlobAtRandomPosition(
-            worldWidth, surfaceHeight, Tile::Type::Iron, IRON_SURFACE_SIZE, IRON_SURFACE_VARIATION);
-    }
-    for (int i = 0; i < ironUndergroundCount; ++i)
-    {
-        FillBlobAtRandomPosition(
-            worldWidth, undergroundHeight, Tile::Type::Iron, IRON_UNDERGROUND_SIZE, IRON_UNDERGROUND_VARIATION);
-    }
-    for (int i = 0; i < ironCavernCount; ++i)
-    {
-        FillBlobAtRandomPosition(worldWidth, cavernHeight, Tile::Type::Iron, IRON_CAVERN_SIZE, IRON_CAVERN_VARIATION);
-    }
-
     constexpr double SILVER_UNDERGROUND_AMOUNT = 2.6E-05;
     constexpr Vector2<double> SILVER_UNDERGROUND_SIZE = Vector2<double>{3, 6};
     constexpr Vector2<double> SILVER_UNDERGROUND_VARIATION = Vector2<double>{0.1, 0.4};
@@ -782,38 +1148,170 @@ void WorldGenerator::GenerateMetals(int surface, int underground, int cavern, in
     constexpr Vector2<double> SILVER_CAVERN_SIZE = Vector2<double>{4, 9};
     constexpr Vector2<double> SILVER_CAVERN_VARIATION = Vector2<double>{0.1, 0.4};
 
-    const int silverUndergroundCount = static_cast<int>(static_cast<double>(m_tiles.size()) * IRON_UNDERGROUND_AMOUNT);
-    const int silverCavernCount = static_cast<int>(static_cast<double>(m_tiles.size()) * IRON_CAVERN_AMOUNT);
-    // SILVER
-    for (int i = 0; i < silverUndergroundCount; ++i)
+    constexpr double GOLD_CAVERN_AMOUNT = 0.00012;
+    constexpr Vector2<double> GOLD_CAVERN_SIZE = Vector2<double>{4, 8};
+    constexpr Vector2<double> GOLD_CAVERN_VARIATION = Vector2<double>{0.1, 0.4};
+
+    struct OreLayer
     {
-        FillBlobAtRandomPosition(
-            worldWidth, undergroundHeight, Tile::Type::Silver, SILVER_UNDERGROUND_SIZE, SILVER_UNDERGROUND_VARIATION);
-    }
-    for (int i = 0; i < silverCavernCount; ++i)
+        Tile::Type type;
+        Vector2<int> height;
+        double amount;
+        Vector2<double> size;
+        Vector2<double> variation;
+    };
+    // In placement order. Silver counts have always used the iron amounts, and gold has always placed silver
+    const std::array<OreLayer, 9> ores{
+        OreLayer{
+            Tile::Type::Copper, surfaceHeight, COPPER_SURFACE_AMOUNT, COPPER_SURFACE_SIZE, COPPER_SURFACE_VARIATION},
+        OreLayer{
+            Tile::Type::Copper,
+            undergroundHeight,
+            COPPER_UNDERGROUND_AMOUNT,
+            COPPER_UNDERGROUND_SIZE,
+            COPPER_UNDERGROUND_VARIATION},
+        OreLayer{Tile::Type::Copper, cavernHeight, COPPER_CAVERN_AMOUNT, COPPER_CAVERN_SIZE, COPPER_CAVERN_VARIATION},
+        OreLayer{Tile::Type::Iron, surfaceHeight, IRON_SURFACE_AMOUNT, IRON_SURFACE_SIZE, IRON_SURFACE_VARIATION},
+        OreLayer{
+            Tile::Type::Iron,
+            undergroundHeight,
+            IRON_UNDERGROUND_AMOUNT,
+            IRON_UNDERGROUND_SIZE,
+            IRON_UNDERGROUND_VARIATION},
+        OreLayer{Tile::Type::Iron, cavernHeight, IRON_CAVERN_AMOUNT, IRON_CAVERN_SIZE, IRON_CAVERN_VARIATION},
+        OreLayer{
+            Tile::Type::Silver,
+            undergroundHeight,
+            IRON_UNDERGROUND_AMOUNT,
+            SILVER_UNDERGROUND_SIZE,
+            SILVER_UNDERGROUND_VARIATION},
+        OreLayer{Tile::Type::Silver, cavernHeight, IRON_CAVERN_AMOUNT, SILVER_CAVERN_SIZE, SILVER_CAVERN_VARIATION},
+        OreLayer{Tile::Type::Silver, cavernHeight, GOLD_CAVERN_AMOUNT, GOLD_CAVERN_SIZE, GOLD_CAVERN_VARIATION},
+    };
+    const auto oreCount = [&](const OreLayer& ore) {
+        return static_cast<int>(static_cast<double>(m_tiles.size()) * ore.amount);
+    };
+
+    if (m_blobStamper.GetMode() == BlobStamper::Mode::Legacy)
     {
-        FillBlobAtRandomPosition(
-            worldWidth, cavernHeight, Tile::Type::Silver, SILVER_CAVERN_SIZE, SILVER_CAVERN_VARIATION);
+        // Legacy blobs draw from the main RNG per cell, so they are placed one at a time
+        for (const OreLayer& ore : ores)
+        {
+            for (int i = 0; i < oreCount(ore); ++i)
+            {
+                FillBlobAtRandomPosition(worldWidth, ore.height, ore.type, ore.size, ore.variation);
+            }
+        }
+        return;
     }
 
-    constexpr double GOLD_CAVERN_AMOUNT = 0.00012;
-    constexpr Vector2<double> GOLD_CAVERN_SIZE = Vector2<double>{4, 8};
-    constexpr Vector2<double> GOLD_CAVERN_VARIATION = Vector2<double>{0.1, 0.4};
+    // Positions come from a blue-noise scatter with the largest blob of each layer as the minimum spacing, so veins
+    // of one layer do not pile on top of each other. Sizes come from the pass's own stream, and every blob is
+    // stamped at once.
+    Random oreStream = m_random.Fork();
+    std::vector<Scatter::Layer> layers;
+    layers.reserve(ores.size());
+    for (const OreLayer& ore : ores)
+    {
+        const Vector2<int> height{ore.height.x, ore.height.y + 1};
+        const double area = static_cast<double>(worldWidth.y - worldWidth.x) * std::max(height.y - height.x, 1);
+        layers.push_back(Scatter::Layer{worldWidth, height, oreCount(ore) / area, ore.size.y});
+    }
+    const std::vector<Scatter::Batch> batches = Scatter::Sample(layers, oreStream.Next());
 
-    const int goldCavernCount = static_cast<int>(static_cast<double>(m_tiles.size()) * GOLD_CAVERN_AMOUNT);
-    // GOLD
-    for (int i = 0; i < goldCavernCount; ++i)
+    std::vector<BlobStamper::Blob> blobs;
+    Vector2<int> rows{static_cast<int>(m_height), 0};
+    for (std::size_t i = 0; i < ores.size(); ++i)
     {
-        FillBlobAtRandomPosition(worldWidth, cavernHeight, Tile::Type::Silver, GOLD_CAVERN_SIZE, GOLD_CAVERN_VARIATION);
+        const OreLayer& ore = ores[i];
+        for (const Vector2<int>& position : batches[i])
+        {
+            const double s = oreStream.GetDouble(ore.size);
+            const double v = oreStream.GetDouble(ore.variation);
+            blobs.push_back(BlobStamper::Blob{position.x, position.y, ore.type, s, v, BlobReplaceSet(false, true)});
+            const int r = static_cast<int>(s / 2) + 1;
+            rows = Vector2<int>{std::min(rows.x, position.y - r), std::max(rows.y, position.y + r)};
+        }
     }
+    m_blobStamper.StampAll(m_tiles, static_cast<int>(m_width), static_cast<int>(m_height), blobs);
+    TilesChanged(0, rows.x, static_cast<int>(m_width), rows.y);
 }
 
 void WorldGenerator::GenerateGems(int start, int end)
 {
+    constexpr double CHANCE_OF_GEM = 1.0 / 200;
+    // Shallowest to deepest: every band of depth leans towards its own gem
+    constexpr std::array<Tile::Type, 6> GEMS{
+        Tile::Type::Amethyst,
+        Tile::Type::Topaz,
+        Tile::Type::Sapphire,
+        Tile::Type::Emerald,
+        Tile::Type::Ruby,
+        Tile::Type::Diamond,
+    };
+
+    if (start >= end)
+    {
+        return;
+    }
+    const int width = static_cast<int>(m_width);
+    const int height = static_cast<int>(m_height);
+    const Bitplane stone = Bitplane::FromTypes(m_tiles, width, height, TileTraits::MakeSet({Tile::Type::Stone}));
+    const Bitplane solid = Bitplane::FromTypes(m_tiles, width, height, TileTraits::SetOf(TileTraits::SOLID));
+
+    // Stone on a cave wall: open space on at least one side
+    const std::vector<std::uint32_t> candidates = SweepCandidates(Vector2<int>{start, end}, [&](int word, int y) {
+        const std::uint64_t open = ~solid.Shifted(word, y, -1, true) | ~solid.Shifted(word, y, 1, true) |
+                                   ~solid.Word(word, y - 1, true) | ~solid.Word(word, y + 1, true);
+        return stone.Word(word, y, false) & open;
+    });
+
+    SparseSampler sampler{m_random, CHANCE_OF_GEM};
+    sampler.Run(static_cast<std::int64_t>(candidates.size()), [&](std::int64_t i) {
+        const int y = static_cast<int>(candidates[i] / m_width);
+        const int band = (y - start) * static_cast<int>(GEMS.size()) / (end - start);
+        const int gem = std::clamp(band + m_random.GetInt(-1, 1), 0, static_cast<int>(GEMS.size()) - 1);
+        m_tiles[candidates[i]].m_type = GEMS[gem];
+    });
+    TilesChanged(0, start, width, end);
 }
 
 void WorldGenerator::GenerateWebs(int start, int end)
 {
+    constexpr double CHANCE_OF_WEB = 1.0 / 40;
+    constexpr Vector2<int> WEB_LENGTH{1, 3};
+
+    if (start >= end)
+    {
+        return;
+    }
+    const int width = static_cast<int>(m_width);
+    const int height = static_cast<int>(m_height);
+    const Bitplane air = Bitplane::FromTypes(m_tiles, width, height, TileTraits::MakeSet({Tile::Type::Air}));
+    const Bitplane solid = Bitplane::FromTypes(m_tiles, width, height, TileTraits::SetOf(TileTraits::SOLID));
+    const Bitplane liquid = Bitplane::FromLiquids(m_tiles, width, height);
+
+    // Dry air right under a solid ceiling
+    const std::vector<std::uint32_t> candidates = SweepCandidates(Vector2<int>{start, end}, [&](int word, int y) {
+        return air.Word(word, y, false) & ~liquid.Word(word, y, true) & solid.Word(word, y - 1, false);
+    });
+
+    // Every web hangs a few tiles down from the ceiling, through dry air only
+    SparseSampler sampler{m_random, CHANCE_OF_WEB};
+    sampler.Run(static_cast<std::int64_t>(candidates.size()), [&](std::int64_t i) {
+        const int length = m_random.GetInt(WEB_LENGTH);
+        std::size_t index = candidates[i];
+        for (int step = 0; step < length && index < m_tiles.size(); ++step, index += m_width)
+        {
+            Tile& tile = m_tiles[index];
+            if (tile.m_type != Tile::Type::Air || tile.m_liquid != Tile::Liquid::None)
+            {
+                break;
+            }
+            tile.m_type = Tile::Type::Web;
+        }
+    });
+    TilesChanged(0, start, width, end + WEB_LENGTH.y);
 }
 #pragma endregion Shinies
 
@@ -825,71 +1323,148 @@ void WorldGenerator::GenerateWebs(int start, int end)
 #pragma region Fixes
 void WorldGenerator::GenerateAnthillCaves(const std::vector<int>& positions)
 {
+    constexpr int TUNNELS_PER_ANTHILL = 2;
+    constexpr Vector2<double> HEADING{0.5, 1.2};
+    constexpr double PULL = 0.08;
+    constexpr double TURN = 0.15;
+    constexpr Vector2<int> STEPS{30, 60};
+    constexpr double STEP_LENGTH = 1.5;
+    constexpr Vector2<double> RADIUS{2, 3.5};
+
+    // Each anthill is hollowed out by tunnels heading down and out to either side of its center
+    std::vector<Tunneler::Worm> worms;
+    for (std::size_t i = 0; i + 1 < positions.size(); i += 2)
+    {
+        for (int tunnel = 0; tunnel < TUNNELS_PER_ANTHILL; ++tunnel)
+        {
+            const double angle = m_random.GetDouble(HEADING);
+            const double heading = tunnel % 2 == 0 ? angle : std::numbers::pi - angle;
+            const int steps = m_random.GetInt(STEPS);
+            worms.push_back(Tunneler::Worm{
+                Vector2<double>{positions[i] + 0.5, positions[i + 1] + 0.5},
+                heading,
+                std::numbers::pi / 2,
+                PULL,
+                TURN,
+                steps,
+                STEP_LENGTH,
+                RADIUS,
+                m_random.Next()});
+        }
+    }
+    DigTunnels(worms);
 }
 
-void WorldGenerator::FixGravitatingSand(const std::vector<int>& surface)
+// Runs the row fixes over the rows within CORRECTION_RADIUS of the current surface of every column in a single
+// top-down scan. Each fix sees a row after the fixes before it have handled it (and after everything they did to
+// earlier rows), and returns false once it is done with the column; the scan stops when every fix is.
+template <class... Fixes>
+void WorldGenerator::RunSurfaceFixes(Fixes... fixes)
 {
     constexpr int CORRECTION_RADIUS = 16;
 
-    for (int x = 0; x < m_width; ++x)
-    {
-        for (int y = surface[x] - CORRECTION_RADIUS; y < surface[x] + CORRECTION_RADIUS; ++y)
+    RunColumns([=, this](Vector2<int> columns) {
+        for (int x = columns.x; x < columns.y; ++x)
         {
-            if (IsTile(x, y, Tile::Type::Sand))
+            std::array<bool, sizeof...(Fixes)> active{};
+            active.fill(true);
+            const int surface = m_surface.Top(x);
+            const int end = std::min(surface + CORRECTION_RADIUS, static_cast<int>(m_height) - 1);
+            for (int y = std::max(surface - CORRECTION_RADIUS, 1); y < end; ++y)
             {
-                while (IsTile(x, y + 1, Tile::Type::Air))
+                std::size_t i = 0;
+                ((active[i] = active[i] && (this->*fixes)(x, y), ++i), ...);
+                if (std::none_of(active.begin(), active.end(), [](bool fix) { return fix; }))
                 {
-                    SetTile(x, ++y, Tile::Type::Sand);
+                    break;
                 }
             }
         }
-    }
+    });
 }
 
-void WorldGenerator::FixDirtWalls(const std::vector<int>& surface)
+// Gravity blocks fall into the air below them. Only rows below y change, so later rows see the settled column
+bool WorldGenerator::FixGravityRow(int x, int y)
 {
-    constexpr int CORRECTION_RADIUS = 16;
-
-    for (int x = 0; x < m_width; ++x)
+    if (HasTrait(x, y, TileTraits::GRAVITY))
     {
-        for (int y = surface[x] - CORRECTION_RADIUS; y < surface[x] + CORRECTION_RADIUS; ++y)
+        const Tile::Type type = m_tiles[x + m_width * y].m_type;
+        while (IsTile(x, y + 1, Tile::Type::Air))
         {
-            if (!IsTile(x, y, Tile::Type::Air))
-            {
-                break;
-            }
-            if (!IsWall(x, y, Tile::Wall::Air))
-            {
-                do
-                {
-                    SetWall(x, y, Tile::Wall::Air);
-                    y++;
-                } while (!IsWall(x, y, Tile::Wall::Air) && IsTile(x, y, Tile::Type::Air));
-                break;
-            }
+            SetTile(x, ++y, type);
         }
     }
+    return true;
 }
 
-void WorldGenerator::FixWaterOnSand(const std::vector<int>& surface)
+// Walls in the open air above the first block are removed
+bool WorldGenerator::FixDirtWallRow(int x, int y)
 {
-    constexpr int CORRECTION_RADIUS = 16;
+    if (!IsTile(x, y, Tile::Type::Air))
+    {
+        return false;
+    }
+    if (IsWall(x, y, Tile::Wall::Air))
+    {
+        return true;
+    }
+    do
+    {
+        SetWall(x, y, Tile::Wall::Air);
+        y++;
+    } while (!IsWall(x, y, Tile::Wall::Air) && IsTile(x, y, Tile::Type::Air));
+    return false;
+}
 
-    for (int x = 0; x < m_width; ++x)
+// Water resting on the first sand block is drained
+bool WorldGenerator::FixWaterRow(int x, int y)
+{
+    if (!IsTile(x, y, Tile::Type::Sand))
     {
-        for (int y = surface[x] - CORRECTION_RADIUS; y < surface[x] + CORRECTION_RADIUS; ++y)
-        {
-            if (IsTile(x, y, Tile::Type::Sand))
-            {
-                SetLiquid(x, y, Tile::Liquid::None);
-                while (IsLiquid(x, y - 1, Tile::Liquid::Water))
-                {
-                    SetLiquid(x, --y, Tile::Liquid::None);
-                }
-                break;
-            }
-        }
+        return true;
     }
+    SetLiquid(x, y, Tile::Liquid::None);
+    while (IsLiquid(x, y - 1, Tile::Liquid::Water))
+    {
+        SetLiquid(x, --y, Tile::Liquid::None);
+    }
+    return false;
+}
+
+void WorldGenerator::FixGravitatingSand()
+{
+    RunSurfaceFixes(&WorldGenerator::FixGravityRow);
+}
+
+void WorldGenerator::FixDirtWalls()
+{
+    RunSurfaceFixes(&WorldGenerator::FixDirtWallRow);
+}
+
+void WorldGenerator::FixWaterOnSand()
+{
+    RunSurfaceFixes(&WorldGenerator::FixWaterRow);
+}
+
+// Same result as FixGravitatingSand, FixDirtWalls and FixWaterOnSand one after another: the wall and water fixes only
+// read rows the gravity fix has already finished with (it only ever moves blocks into rows below the one it is on)
+void WorldGenerator::FixSurface()
+{
+    RunSurfaceFixes(&WorldGenerator::FixGravityRow, &WorldGenerator::FixDirtWallRow, &WorldGenerator::FixWaterRow);
+}
+
+void WorldGenerator::SettleGravity()
+{
+    SettleGravity(Vector2<int>{0, static_cast<int>(m_width)}, Vector2<int>{0, static_cast<int>(m_height)});
+}
+
+void WorldGenerator::SettleGravity(Vector2<int> horizontal, Vector2<int> vertical)
+{
+    RunColumns([=, this](Vector2<int> columns) {
+        const Vector2<int> strip{std::max(horizontal.x, columns.x), std::min(horizontal.y, columns.y)};
+        Gravity::Settle(m_tiles, static_cast<int>(m_width), strip, vertical);
+        TilesChanged(strip.x, vertical.x, strip.y, vertical.y);
+    });
 }
 #pragma endregion Fixes
 
@@ -901,19 +1476,51 @@ void WorldGenerator::FixWaterOnSand(const std::vector<int>& surface)
 #pragma region Clean Up
 void WorldGenerator::SmoothWorld()
 {
+    const Bitplane solid = Bitplane::FromTypes(
+        m_tiles, static_cast<int>(m_width), static_cast<int>(m_height), TileTraits::SetOf(TileTraits::SOLID));
+    Slopes::Classify(solid, m_styles);
 }
 
 void WorldGenerator::SettleLiquids()
 {
+    // Far more than any pool needs; only a liquid that never comes to rest would reach it
+    constexpr std::size_t MAX_STEPS = 20000;
+
+    Liquids::Settle(m_tiles, static_cast<int>(m_width), static_cast<int>(m_height), MAX_STEPS);
 }
 
+// Terraria's waterfalls are liquid spilling over a half brick, so the edge blocks of pools that could spill become
+// half bricks
 void WorldGenerator::AddWaterfalls()
 {
+    constexpr std::size_t COLUMNS_PER_WATERFALL = 50;
+
+    const int width = static_cast<int>(m_width);
+    const int height = static_cast<int>(m_height);
+    const Bitplane solid = Bitplane::FromTypes(m_tiles, width, height, TileTraits::SetOf(TileTraits::SOLID));
+    const Bitplane liquid = Bitplane::FromLiquids(m_tiles, width, height);
+
+    // Blocks with liquid on top and an empty tile to either side
+    std::vector<std::uint32_t> candidates = SweepCandidates(Vector2<int>{1, height}, [&](int word, int y) {
+        const auto empty = [&](int dx) {
+            return ~solid.Shifted(word, y, dx, true) & ~liquid.Shifted(word, y, dx, false);
+        };
+        return solid.Word(word, y, false) & liquid.Word(word, y - 1, false) & (empty(-1) | empty(1));
+    });
+
+    // A partial shuffle picks the waterfalls without looking at the rest of the list
+    const std::size_t count = std::min(candidates.size(), m_width / COLUMNS_PER_WATERFALL);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::size_t pick = i + m_random.GetInt(0, static_cast<int>(candidates.size() - i) - 1);
+        std::swap(candidates[i], candidates[pick]);
+        m_styles[candidates[i]] = Tile::Style::HalfBrick;
+    }
 }
 #pragma endregion Clean Up
 
 // Finalize World
 World WorldGenerator::Finish()
 {
-    return World{std::move(m_tiles), m_width, m_height};
+    return World{std::move(m_tiles), std::move(m_styles), m_width, m_height};
 }
\ No newline at end of file
@@ -1,11 +1,27 @@
 #pragma once
 
+#include "biome_map.hpp"
+#include "blob_stamper.hpp"
+#include "caves.hpp"
+#include "distance_field.hpp"
+#include "erosion.hpp"
+#include "flood_fill.hpp"
+#include "placement_index.hpp"
+#include "prefab.hpp"
 #include "random.hpp"
+#include "surface_index.hpp"
 #include "tile.hpp"
+#include "tile_counts.hpp"
+#include "tile_traits.hpp"
+#include "tunneler.hpp"
+#include "type_remap.hpp"
 #include "world.hpp"
 #include "world_size.hpp"
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <vector>
 
 class WorldGenerator
@@ -15,16 +31,69 @@ class WorldGenerator
     std::size_t m_height;
     WorldSize m_size;
     std::vector<Tile> m_tiles;
+    std::vector<Tile::Style> m_styles;
     Random m_random;
+    BlobStamper m_blobStamper;
+    PlacementIndex m_placement;
+    SurfaceIndex m_surface;
+    TileCounts m_counts;
+    BiomeMap m_biomes;
 
-    int ComputeStartCoordinate(int side);
-    int ComputeWithinUsableArea(
-        const std::vector<int>& surfaceTerrain, int side, int size, Tile::Type mask = Tile::Type::Air);
+    [[nodiscard]] Vector2<int> ComputeStartRange(int side) const;
+    std::optional<int> ComputeWithinUsableArea(int side, int size, TileTraits::TypeSet forbiddenEnds = 0);
+    void ClaimSurface(int start, int size);
+    // Brings the surface and count indexes up to date after a bulk write to the half-open rectangle
+    void TilesChanged(int left, int top, int right, int bottom);
+    // Carves the worms' tunnels through solid tiles all at once
+    void DigTunnels(const std::vector<Tunneler::Worm>& worms);
+    template <class Rows, class Evaluate>
+    void ForEachInRegion(const char* pass, Rows rows, TileTraits::TypeSet precondition, Evaluate evaluate);
+    void RunColumns(std::function<void(Vector2<int>)> pass);
+    // Tiles in the rows whose bit edges(word, y) sets, in row order
+    template <class Edges>
+    [[nodiscard]] std::vector<std::uint32_t> SweepCandidates(Vector2<int> rows, Edges edges) const;
+    [[nodiscard]] int StripWidth() const;
+    template <class... Fixes>
+    void RunSurfaceFixes(Fixes... fixes);
+    bool FixGravityRow(int x, int y);
+    bool FixDirtWallRow(int x, int y);
+    bool FixWaterRow(int x, int y);
     void FillBlobAtRandomPosition(
         Vector2<int> horizontal, Vector2<int> vertical, Tile::Type, Vector2<double> size, Vector2<double> variation);
 
+  public:
+    // Tiles a region-driven pass ran its per-tile work on, and tiles it never looked at
+    struct RegionStats
+    {
+        const char* pass;
+        std::size_t evaluated;
+        std::size_t skipped;
+    };
+
+  private:
+    std::vector<RegionStats> m_regionStats;
+    std::mutex m_statsMutex;
+    // Strip-mined execution of column-local passes
+    bool m_stripMining{true};
+    int m_stripWidth{0};
+    bool m_queueing{false};
+    std::vector<std::function<void(Vector2<int>)>> m_stripPasses;
+    bool m_erosion{true};
+
   public:
     WorldGenerator(WorldSize size, std::uint64_t seed);
+    // Legacy reproduces the original per-cell FillBlob output and random sequence exactly
+    void SetBlobMode(BlobStamper::Mode mode);
+    // Strip width 0 picks one from the cache size; disabling runs every pass over the whole world as it is called
+    void SetStripMining(bool enabled, int stripWidth = 0);
+    // Whether RandomTerrain erodes the profiles it returns
+    void SetErosion(bool enabled);
+    // Column-local passes called between these two are queued, then run strip by strip: every strip of columns goes
+    // through all of them while it is still in cache, and strips run in parallel. Anything that is not column-local
+    // (ores, structures, random walks) is a barrier and must be called outside. Passes keep their own copies of their
+    // arguments, and their random draws happen when they are called, so the result matches running them in order.
+    void BeginStrips();
+    void EndStrips();
     void SetTile(int x, int y, Tile::Type type);
     void SetWall(int x, int y, Tile::Wall wall);
     void SetLiquid(int x, int y, Tile::Liquid liquid);
@@ -32,6 +101,9 @@ class WorldGenerator
     bool IsTile(int x, int y, Tile::Type type);
     bool IsWall(int x, int y, Tile::Wall wall);
     bool IsLiquid(int x, int y, Tile::Liquid liquid);
+    bool HasTrait(int x, int y, TileTraits::Mask traits);
+    // Row of the topmost solid tile of the column as the world is now, or the height if there is none
+    [[nodiscard]] int GetSurface(int x) const;
     void FillBlob(
         int x,
         int y,
@@ -40,9 +112,27 @@ class WorldGenerator
         double variation,
         bool replaceAir = false,
         bool overrideBlocks = true);
+    // Converts every tile in the region through the table in one pass; column-local, so it can run in strips
+    void RemapTypes(const TypeRemap::Table& table, Vector2<int> horizontal, Vector2<int> vertical);
+    // Converts the tiles set in the mask over the half-open rows. Not column-local
+    void RemapTypes(const TypeRemap::Table& table, const Bitplane& mask, Vector2<int> rows);
+    // Pours up to volume tiles of liquid into the basin under the seed, level by level up to any spill point
+    FloodFill::Result FillBasin(Vector2<int> seed, Tile::Liquid liquid, double volume);
+    // Stamps a prefab with its top left corner at position, optionally mirrored
+    void PlacePrefab(const Prefab& prefab, Vector2<int> position, bool flipX = false, bool flipY = false);
     int RandomHeight(double min, double max);
     std::vector<int> RandomTerrain(int minHeight, int maxHeight, double amplitude, int timer);
+    // Slumps loose blocks in the top rows down slopes steeper than talus rows per column. Not column-local
+    void ErodeSurface(int rows, int talus, int steps);
     [[nodiscard]] std::size_t GetHeight() const;
+    [[nodiscard]] const std::vector<RegionStats>& GetRegionStats() const;
+    // Distance from every tile to the nearest tile of one of the given types, for falloffs around features
+    [[nodiscard]] DistanceField DistanceTo(TileTraits::TypeSet features) const;
+    // Number of tiles of the given types in the half-open region, in constant time once the types have a table
+    std::uint32_t CountTypes(TileTraits::TypeSet types, Vector2<int> horizontal, Vector2<int> vertical);
+    // Biome the tile is in and how strongly, from the coarse biome map the biome passes paint
+    [[nodiscard]] BiomeMap::Biome GetBiome(int x, int y) const;
+    [[nodiscard]] double GetBiomeWeight(BiomeMap::Biome biome, int x, int y) const;
 
     // World Setup
     void GenerateDepthLevels(int surface, int cavern, int underworld);
@@ -55,9 +145,14 @@ class WorldGenerator
     void GenerateUndergroundStone(const std::vector<int>& start, const std::vector<int>& end);
     void GenerateCavernDirt(const std::vector<int>& start, int end);
     // Caves
-    void GenerateCaves(const std::vector<int>& undergroundStart);
-    void GenerateEntranceCaves(const std::vector<int>& surface);
-    void GenerateLargeCaves(const std::vector<int>& cavernStart);
+    void GenerateCaves(const std::vector<int>& undergroundStart, int underworld);
+    // Winding tunnels from the current surface down into the caves
+    void GenerateEntranceCaves();
+    void GenerateLargeCaves(const std::vector<int>& cavernStart, int underworld);
+    // Cellular-automaton pass over the rows [top, bottom) that fills speckle and rounds off jagged cave walls
+    void SmoothCaves(int top, int bottom);
+    // Splits the open (non-solid) space of the world into separate caves
+    [[nodiscard]] Caves::Labels LabelCaves() const;
     // Scattered Blocks
     void GenerateClay(const std::vector<int>& start, const std::vector<int>& mid, const std::vector<int>& end);
     void GenerateGrass(const std::vector<int>& start, int end);
@@ -66,14 +161,22 @@ class WorldGenerator
     // Biomes Part 1
     // Metals, Gems, and Webs
     void GenerateMetals(int surface, int underground, int cavern, int underworld);
+    // Gems and webs are sampled from the cave walls and ceilings between the rows start and end, found in one sweep
     void GenerateGems(int start, int end);
     void GenerateWebs(int start, int end);
     // Biomes Part 2
     // Fixes
+    // Tunnels through the anthills, from the x, y pairs GenerateAnthills returned
     void GenerateAnthillCaves(const std::vector<int>& positions);
-    void FixGravitatingSand(const std::vector<int>& surface);
-    void FixDirtWalls(const std::vector<int>& surface);
-    void FixWaterOnSand(const std::vector<int>& surface);
+    // Surface fixes work around the current surface of each column
+    void FixGravitatingSand();
+    void FixDirtWalls();
+    void FixWaterOnSand();
+    // All of the above in one scan per column
+    void FixSurface();
+    // Drops every falling block (sand, silt, slush) in the half-open region onto whatever is below it
+    void SettleGravity();
+    void SettleGravity(Vector2<int> horizontal, Vector2<int> vertical);
     // Biomes Part 3
     // Clean up World
     void SmoothWorld();